@@ -0,0 +1,176 @@
+#include "compressor.h"
+
+using namespace std;
+
+const char* const Compressor::COMPRESSIBLE_TYPE[] = {
+    "application/xhtml+xml",
+    "application/rtf",
+    "application/javascript",
+    "application/json",
+    "image/svg+xml",
+};
+
+Compressor::Compressor(): capacity_(64 * 1024 * 1024), size_(0) {}
+
+Compressor* Compressor::Instance(){
+    static Compressor inst;
+    return &inst;
+}
+
+Compressor::ENCODING Compressor::Negotiate(const string& acceptEncoding){
+    // 每种编码三种状态：未提及 0、接受 1、拒绝 -1；明确列出的编码优先于 "*"
+    int gzip = 0, deflate = 0, star = 0;
+    size_t i = 0, n = acceptEncoding.size();
+    while(i < n){
+        // 逐个取出 "token;q=x" 片段
+        size_t end = acceptEncoding.find(',', i);
+        if(end == string::npos) { end = n; }
+        size_t semi = acceptEncoding.find(';', i);
+        size_t nameEnd = (semi < end) ? semi : end;
+
+        size_t b = i, e = nameEnd;
+        while(b < e && acceptEncoding[b] == ' ') { b++; }
+        while(e > b && acceptEncoding[e - 1] == ' ') { e--; }
+        string name = acceptEncoding.substr(b, e - b);
+        for(auto& ch : name) { ch = tolower(ch); }
+
+        // q=0 表示明确拒绝该编码
+        int state = 1;
+        if(semi < end){
+            size_t q = acceptEncoding.find("q=", semi);
+            if(q < end && atof(acceptEncoding.c_str() + q + 2) <= 0.0){
+                state = -1;
+            }
+        }
+        if(name == "gzip") { gzip = state; }
+        else if(name == "deflate") { deflate = state; }
+        else if(name == "*") { star = state; }
+        i = end + 1;
+    }
+    if(gzip == 0) { gzip = star; }
+    if(deflate == 0) { deflate = star; }
+    if(gzip > 0) { return GZIP; }
+    if(deflate > 0) { return DEFLATE; }
+    return IDENTITY;
+}
+
+const char* Compressor::EncodingName(ENCODING enc){
+    switch(enc){
+    case GZIP:
+        return "gzip";
+    case DEFLATE:
+        return "deflate";
+    default:
+        return "identity";
+    }
+}
+
+bool Compressor::Compressible(const char* type){
+    if(strncmp(type, "text/", 5) == 0){
+        return true;
+    }
+    for(const char* t : COMPRESSIBLE_TYPE){
+        if(strcmp(type, t) == 0) { return true; }
+    }
+    return false;
+}
+
+bool Compressor::ShouldCompress(const char* type, size_t len){
+    return len >= MIN_SIZE && Compressible(type);
+}
+
+bool Compressor::Compress(const char* data, size_t len, ENCODING enc, string& out){
+    assert(data);
+    if(enc == IDENTITY) { return false; }
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    // windowBits 加 16 输出 gzip 头尾，否则为 zlib 格式
+    int windowBits = (enc == GZIP) ? 15 + 16 : 15;
+    if(deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK){
+        LOG_ERROR("deflateInit2 error!");
+        return false;
+    }
+    out.resize(deflateBound(&zs, len));
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zs.avail_in = static_cast<uInt>(len);
+    zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    zs.avail_out = static_cast<uInt>(out.size());
+    int ret = deflate(&zs, Z_FINISH);
+    deflateEnd(&zs);
+    if(ret != Z_STREAM_END){
+        LOG_ERROR("deflate error: %d", ret);
+        out.clear();
+        return false;
+    }
+    out.resize(zs.total_out);
+    return true;
+}
+
+string Compressor::Key_(const string& path, time_t mtime, ENCODING enc){
+    return path + '\0' + to_string(mtime) + '\0' + EncodingName(enc);
+}
+
+shared_ptr<const string> Compressor::Find(const string& path, time_t mtime, ENCODING enc){
+    string key = Key_(path, mtime, enc);
+    lock_guard<mutex> locker(mtx_);
+    auto it = cache_.find(key);
+    if(it == cache_.end()){
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.it);
+    return it->second.data;
+}
+
+shared_ptr<const string> Compressor::Get(const string& path, time_t mtime, ENCODING enc,
+                                         const char* data, size_t len){
+    auto cached = Find(path, mtime, enc);
+    if(cached){
+        return cached;
+    }
+    string key = Key_(path, mtime, enc);
+    /* 压缩放在锁外进行，避免大文件压缩时阻塞其他工作线程 */
+    auto zipped = make_shared<string>();
+    if(!Compress(data, len, enc, *zipped)){
+        return nullptr;
+    }
+    LOG_DEBUG("compress %s: %zu -> %zu (%s)", path.c_str(), len, zipped->size(), EncodingName(enc));
+    shared_ptr<const string> result = zipped;
+    {
+        lock_guard<mutex> locker(mtx_);
+        auto it = cache_.find(key);
+        if(it != cache_.end()){
+            /* 其他线程已经先放入了缓存 */
+            lru_.splice(lru_.begin(), lru_, it->second.it);
+            return it->second.data;
+        }
+        if(result->size() > capacity_){
+            return result;
+        }
+        lru_.push_front(key);
+        cache_[key] = {result, lru_.begin()};
+        size_ += result->size();
+        Evict_();
+    }
+    return result;
+}
+
+void Compressor::Evict_(){
+    while(size_ > capacity_ && !lru_.empty()){
+        auto it = cache_.find(lru_.back());
+        assert(it != cache_.end());
+        size_ -= it->second.data->size();
+        cache_.erase(it);
+        lru_.pop_back();
+    }
+}
+
+void Compressor::SetCapacity(size_t bytes){
+    lock_guard<mutex> locker(mtx_);
+    capacity_ = bytes;
+    Evict_();
+}
+
+size_t Compressor::Size(){
+    lock_guard<mutex> locker(mtx_);
+    return size_;
+}
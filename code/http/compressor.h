@@ -0,0 +1,74 @@
+#ifndef COMPRESSOR_H
+#define COMPRESSOR_H
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+#include <time.h>
+#include <zlib.h>       // gzip / deflate 压缩
+
+#include "../log/log.h"
+
+// 响应压缩：按 MIME 类型和最小长度决定是否压缩，压缩结果按 (path, mtime, encoding) 缓存，
+// 同一份静态资源只压缩一次。压缩发生在 HttpConn::process 中，即运行在线程池的工作线程里，不会阻塞主线程的 epoll 循环。
+class Compressor{
+public:
+    enum ENCODING{
+        IDENTITY = 0,   // 不压缩
+        DEFLATE,        // zlib 格式 (Content-Encoding: deflate)
+        GZIP,           // gzip 格式 (Content-Encoding: gzip)
+    };
+
+    static Compressor* Instance();
+
+    // 解析请求头 Accept-Encoding，选出双方都支持的最优编码（gzip 优先）
+    static ENCODING Negotiate(const std::string& acceptEncoding);
+    // 编码名，用于 Content-Encoding 头
+    static const char* EncodingName(ENCODING enc);
+    // 该 MIME 类型是否值得压缩（图片、视频等已压缩格式返回 false）
+    static bool Compressible(const char* type);
+    // 压缩策略：类型可压缩且长度不小于 MIN_SIZE
+    static bool ShouldCompress(const char* type, size_t len);
+    // 一次性压缩 data，结果写入 out，失败返回 false
+    static bool Compress(const char* data, size_t len, ENCODING enc, std::string& out);
+
+    // 带缓存的压缩：命中直接返回，未命中则压缩 data 并放入缓存；失败返回 nullptr
+    // 返回 shared_ptr，淘汰缓存项时正在发送的连接仍持有数据，不会悬空
+    std::shared_ptr<const std::string> Get(const std::string& path, time_t mtime, ENCODING enc,
+                                           const char* data, size_t len);
+    // 只查缓存，未命中返回 nullptr，不做压缩
+    std::shared_ptr<const std::string> Find(const std::string& path, time_t mtime, ENCODING enc);
+    // 设置缓存容量（字节），超出后按 LRU 淘汰
+    void SetCapacity(size_t bytes);
+    size_t Size();
+
+    // 小于该长度的响应体压缩收益太小，直接原样发送
+    static const size_t MIN_SIZE = 1024;
+
+private:
+    Compressor();
+    ~Compressor() = default;
+
+    static std::string Key_(const std::string& path, time_t mtime, ENCODING enc);
+    // 淘汰最久未使用的缓存项，直到总大小不超过容量
+    void Evict_();
+
+    struct Entry{
+        std::shared_ptr<const std::string> data;
+        std::list<std::string>::iterator it;    // 在 lru_ 中的位置
+    };
+
+    size_t capacity_;
+    size_t size_;
+    // 表头为最近使用
+    std::list<std::string> lru_;
+    std::unordered_map<std::string, Entry> cache_;
+    std::mutex mtx_;
+
+    // text/* 之外仍然可压缩的 MIME 类型
+    static const char* const COMPRESSIBLE_TYPE[];
+};
+
+#endif //COMPRESSOR_H
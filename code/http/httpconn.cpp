@@ -12,6 +12,8 @@ HttpConn::HttpConn(){
     fd_ = -1;
     addr_ = {0};
     isClose_ = true;
+    badRequest_ = false;
+    generation_ = 0;
 }
 
 HttpConn::~HttpConn(){
@@ -27,6 +29,8 @@ void HttpConn::init(int fd, const sockaddr_in& addr){
     writeBuff_.RetrieveAll();
     readBuff_.RetrieveAll();
     isClose_ = false;
+    badRequest_ = false;
+    generation_.fetch_add(1, memory_order_release);
     LOG_INFO("Client[%d](%s:%d) in, userCount:%d", fd_, GetIP(), GetPort(), (int)userCount);
 }
 
@@ -35,6 +39,7 @@ void HttpConn::Close(){
     response_.UnmapFile();
     if(isClose_ == false){
         isClose_ = true;
+        generation_.fetch_add(1, memory_order_release);
         userCount--;
         close(fd_);
         LOG_INFO("Client[%d](%s:%d) quit, UserCount:%d", fd_, GetIP(), GetPort(), (int)userCount);
@@ -97,32 +102,62 @@ ssize_t HttpConn::write(int* saveErrno){
 }
 
 bool HttpConn::process(){
+    if(!parse()){
+        return false; // 告诉 WebServer：别急，继续监听 EPOLLIN，等下一波数据
+    }
+    respond();
+    return true;
+}
+
+bool HttpConn::parse(){
     // 1. 如果读缓冲区没数据，没法处理
     if(readBuff_.ReadableBytes() <= 0){
         return false;
     }
-    // 1. 调用 parse
-    bool isValid = request_.parse(readBuff_);
-    // 【情况 1: 格式错误】 -> 返回 false (Bad Request)
-    if (!isValid) {
+    // 2. 调用 parse
+    badRequest_ = !request_.parse(readBuff_);
+    // 【情况 1: 格式错误】 -> 回复 400 (Bad Request)
+    // 【情况 2: 解析完成】 -> 可以生成响应
+    // 【情况 3: 解析未完】 -> isValid 是 true，但 state 还没到 FINISH
+    return badRequest_ || request_.state() == HttpRequest::FINISH;
+}
+
+void HttpConn::respond(int code, bool deferCompress){
+    if (badRequest_) {
         LOG_ERROR("Syntax Error");
-        response_.Init(srcDir, request_.path(), false, 400);; // 准备 400 页面
+        response_.Init(srcDir, request_.path(), false, 400); // 准备 400 页面
+        badRequest_ = false;
     }
-    // 到了这里，说明 isValid == true，数据目前是合法的
-    // 接下来区分是“完事了”还是“还要等”
-    else if(request_.state() == HttpRequest::FINISH){
+    else if(code == 503){
+        // 阻塞通道已满：不等数据库，直接告诉客户端稍后再试
+        response_.Init(srcDir, request_.path(), request_.IsKeepAlive(), 503);
+    }
+    else{
         // 解析成功 (200 OK)
         LOG_DEBUG("%s", request_.path().c_str());
-        // 初始化响应：设置路径，状态码200
-        response_.Init(srcDir, request_.path(), request_.IsKeepAlive(), 200);
-    }else{
-        // 【情况 3: 解析未完】 -> Incomplete
-        // isValid 是 true，但 state 还没到 FINISH
-        return false; // 告诉 WebServer：别急，继续监听 EPOLLIN，等下一波数据
+        // 登录/注册：查询数据库后把路径改写为欢迎页或错误页
+        if(request_.IsBlocking()){
+            request_.HandlePost();
+        }
+        // 初始化响应：设置路径，状态码200，并按 Accept-Encoding 协商压缩编码
+        response_.Init(srcDir, request_.path(), request_.IsKeepAlive(), 200,
+                       Compressor::Negotiate(request_.GetHeader("Accept-Encoding")));
+        response_.SetSession(request_.NewSession());
+        response_.SetDeferCompress(deferCompress);
     }
 
     // 3. 生成响应头，写入 writeBuff_
     response_.MakeResponse(writeBuff_);
+    SetIov_();
+    request_.Init();
+}
+
+void HttpConn::FinishLoad(bool compressNow){
+    response_.FinishDeferred(writeBuff_, compressNow);
+    SetIov_();
+}
+
+void HttpConn::SetIov_(){
     /* 响应头 */
     iov_[0].iov_base = const_cast<char*>(writeBuff_.Peek());
     iov_[0].iov_len = writeBuff_.ReadableBytes();
@@ -134,7 +169,5 @@ bool HttpConn::process(){
         iov_[1].iov_len = response_.FileLen();
         iovCnt_ = 2;
     }
-    LOG_DEBUG("filesize:%d, %d to %d", response_.FileLen(), iovCnt_, ToWriteBytes());
-    request_.Init();
-    return true;
-}
\ No newline at end of file
+    LOG_DEBUG("filesize:%zu, %d to %d", response_.FileLen(), iovCnt_, ToWriteBytes());
+}
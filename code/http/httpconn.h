@@ -8,7 +8,6 @@
 #include <errno.h> //定义了错误码宏, EAGAIN / EWOULDBLOCK：这是非阻塞 I/O 中最重要的错误码
 
 #include "../log/log.h"
-#include "../pool/sqlconnRAII.h"
 #include "../buffer/buffer.h"
 #include "httprequest.h"
 #include "httpresponse.h"
@@ -27,13 +26,34 @@ public:
     ssize_t write(int* saveErrno);
 
     void Close();
+    //连接代数：init 和 Close 各加一。连接交给其他线程或挂起的协程之前记下，回到 Reactor 线程后
+    //与当前值不同说明连接已被关闭（fd 可能已复用给新连接），不能再访问
+    uint32_t Generation() const{
+        return generation_.load(std::memory_order_acquire);
+    }
     int GetFd() const;
     int GetPort() const;
     const char* GetIP() const;
     sockaddr_in GetAddr() const;
 
-    //这是由工作线程（ThreadPool）调用的主逻辑函数
+    //这是由工作线程（ThreadPool）调用的主逻辑函数：parse() + respond()
     bool process();
+    //解析读缓冲区：请求完整（或格式错误）返回 true，半包返回 false
+    bool parse();
+    //请求是否需要阻塞的数据库操作（登录/注册），见 HttpRequest::IsBlocking
+    bool IsBlocking() const{
+        return !badRequest_ && request_.IsBlocking();
+    }
+    //异步验证登录/注册（见 HttpRequest::LoginForm / SetVerified）
+    bool LoginForm(std::string* name, std::string* pwd, bool* isLogin){
+        return !badRequest_ && request_.LoginForm(name, pwd, isLogin);
+    }
+    void SetVerified(bool ok){
+        request_.SetVerified(ok);
+    }
+    //生成响应并准备 iov_；code 为 503 时直接回复服务器繁忙（阻塞通道已满）
+    //deferCompress 为 true 时压缩缓存未命中的文件留给读盘任务压缩（见 HttpResponse::SetDeferCompress）
+    void respond(int code = -1, bool deferCompress = false);
 
     int ToWriteBytes(){
         return iov_[0].iov_len + iov_[1].iov_len;
@@ -42,6 +62,13 @@ public:
     bool IsKeepAlive() const{
         return request_.IsKeepAlive();
     }
+
+    // 待发送的文件不在页缓存时返回读盘任务，否则为空（见 HttpResponse::ColdFileLoader）
+    std::function<void()> ColdFileLoader() const{
+        return response_.ColdFileLoader();
+    }
+    // 读盘任务完成后补全推迟压缩的响应并重新准备 iov_（见 HttpResponse::FinishDeferred）
+    void FinishLoad(bool compressNow);
     
     // 是否开启 Epoll 的 ET (Edge Trigger) 模式
     static bool isET;
@@ -51,10 +78,15 @@ public:
     static std::atomic<int> userCount;
 
 private:
+    //响应头在 writeBuff_ 中，响应体（如有）作为第二段
+    void SetIov_();
+
     int fd_;
     struct sockaddr_in addr_;
 
     bool isClose_;
+    bool badRequest_;   // parse() 遇到格式错误，respond() 回复 400
+    std::atomic<uint32_t> generation_;
 
     int iovCnt_;
     struct iovec iov_[2];
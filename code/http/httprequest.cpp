@@ -12,7 +12,7 @@ const unordered_map<string,int> HttpRequest::DEFAULT_HTML_TAG{
 
 //重置请求解析状态、清空成员变量，为新请求做准备；
 void HttpRequest::Init(){
-    method_ = path_ = version_ = body_ = "";
+    method_ = path_ = version_ = body_ = session_ = "";
     state_ = REQUEST_LINE;
     header_.clear();
     post_.clear();
@@ -25,6 +25,59 @@ bool HttpRequest::IsKeepAlive() const{
     return false;
 }
 
+bool HttpRequest::IsBlocking() const{
+    return state_ == FINISH && method_ == "POST" && DEFAULT_HTML_TAG.count(path_)
+        && GetHeader("Content-Type") == "application/x-www-form-urlencoded";
+}
+
+void HttpRequest::HandlePost(){
+    ParsePost_();
+}
+
+bool HttpRequest::LoginForm(string* name, string* pwd, bool* isLogin){
+    assert(name && pwd && isLogin);
+    if(!IsBlocking()) { return false; }
+    int tag = DEFAULT_HTML_TAG.find(path_)->second;
+    if(tag != 0 && tag != 1) { return false; }
+    if(post_.empty()) { ParseFromUrlencoded_(); }
+    *name = post_["username"];
+    *pwd = post_["password"];
+    *isLogin = (tag == 1);
+    return true;
+}
+
+void HttpRequest::SetVerified(bool ok){
+    path_ = ok ? "/welcome.html" : "/error.html";
+    if(ok) { session_ = SessionStore::Instance()->Create(post_["username"]); }
+}
+
+void HttpRequest::CheckSession_(){
+    if(!SessionStore::Instance()->Enabled() || DEFAULT_HTML_TAG.find(path_)->second != 1) { return; }
+    // Cookie: a=1; session=<id>.<sig>; b=2
+    auto it = header_.find("Cookie");
+    if(it == header_.end()) { return; }
+    const string& cookie = it->second;
+    string prefix = string(SessionStore::COOKIE_NAME) + "=";
+    string value;
+    for(size_t pos = 0; pos < cookie.size() && value.empty(); ){
+        size_t end = cookie.find(';', pos);
+        if(end == string::npos) { end = cookie.size(); }
+        size_t start = cookie.find_first_not_of(' ', pos);
+        if(start < end && cookie.compare(start, prefix.size(), prefix) == 0){
+            value = cookie.substr(start + prefix.size(), end - start - prefix.size());
+        }
+        pos = end + 1;
+    }
+    string user;
+    if(!SessionStore::Instance()->Check(value, &user)) { return; }
+    ParseFromUrlencoded_();
+    if(post_["username"] == user){
+        LOG_DEBUG("Session hit: %s", user.c_str());
+        path_ = "/welcome.html";// 已登录的同一用户：不再验证
+        session_ = value;       // 服务端已续期：重新下发同一 Cookie，让浏览器端的 Max-Age 也从现在算起
+    }
+}
+
 bool HttpRequest::parse(Buffer& buff){
     // HTTP协议的行分隔符（回车+换行）
     const char CRLF[] = "\r\n";
@@ -78,6 +131,7 @@ bool HttpRequest::parse(Buffer& buff){
                 break;
         }
     }
+    if(IsBlocking()) { CheckSession_(); }
     LOG_DEBUG("[%s], [%s], [%s]", method_.c_str(), path_.c_str(), version_.c_str());
     return true;
 }
@@ -153,17 +207,14 @@ void HttpRequest::ParsePost_(){
     //仅处理POST 请求且Content-Type 为表单格式（application/x-www-form-urlencoded）的情况，过滤其他类型的请求（如 GET、JSON 格式的 POST）
     if(method_ == "POST" && header_["Content-Type"] == "application/x-www-form-urlencoded"){
         //调用ParseFromUrlencoded_()函数，将body_中的 URL 编码字符串（如username=admin&password=123）解析为键值对
-        ParseFromUrlencoded_();
+        if(post_.empty()) { ParseFromUrlencoded_(); }// 会话快速路径可能已经解析过
         if(DEFAULT_HTML_TAG.count(path_)){
             int tag = DEFAULT_HTML_TAG.find(path_)->second;
             LOG_DEBUG("Tag:%d", tag);
             if(tag == 0 || tag == 1){
                 bool isLogin = (tag == 1);
-                if(UserVerify(post_["username"],post_["password"],isLogin)){
-                    path_ = "/welcome.html"; // 验证成功：重定向到欢迎页
-                }else{
-                    path_ = "/error.html"; // 验证失败：重定向到错误页
-                }
+                // 验证成功：重定向到欢迎页并下发会话；失败：重定向到错误页
+                SetVerified(UserVerify(post_["username"],post_["password"],isLogin));
             }
         }
     }
@@ -212,63 +263,49 @@ void HttpRequest::ParseFromUrlencoded_(){
 
 bool HttpRequest::UserVerify(const string& name, const string &pwd, bool isLogin){
     if(name == "" || pwd == ""){return false;}
-    LOG_INFO("Verify name:%s pwd:%s", name.c_str(),pwd.c_str());
-    MYSQL* sql;
-    SqlConnRAII(&sql, SqlConnPool::Instance());
-    assert(sql);
-
+    LOG_INFO("Verify name:%s", name.c_str());
+    /* 先查进程内缓存：命中的用户、过滤器确定不存在的用户名都不用查数据库 */
+    UserCache* cache = UserCache::Instance();
+    bool match;
+    if(cache->Get(name, pwd, &match)){
+        return isLogin && match;// 登录比对密码；注册时用户名已被占用
+    }
+    bool known = cache->MayExist(name);
+    if(!known){
+        cache->Filtered();
+        if(isLogin){return false;}// 用户不存在
+    }
     bool flag = false;// 最终验证结果标记
-    unsigned int j = 0;
-    char order[256] = {0};// 存储SQL语句的缓冲区
-    MYSQL_FIELD *fields = nullptr;// 字段信息
-    MYSQL_RES *res = nullptr;// 数据库查询结果集
-
     if(!isLogin){flag = true;}// 注册场景：先假设用户名可用（后续查询存在则改为false）
-    /* 查询用户及密码 */
-    snprintf(order,256,"SELECT username,password FROM user WHERE username='%s' LIMIT 1", name.c_str());
-    LOG_DEBUG("%s", order);// 日志输出SQL语句（调试用）
 
-    if(mysql_query(sql,order)){// 执行SQL查询
-        mysql_free_result(res);// 释放结果集（避免内存泄漏）
-        return false;// 查询失败直接返回false
-    }
-    res = mysql_store_result(sql);// 获取查询结果集（全部加载到内存）
-    j = mysql_num_fields(res);// 获取结果集的字段数（未实际使用）
-    fields = mysql_fetch_fields(res);// 获取字段信息（未实际使用）
-
-    while(MYSQL_ROW row = mysql_fetch_row(res)){// 遍历结果集（最多1条，因LIMIT 1）
-        LOG_DEBUG("MYSQL ROW: %s %s", row[0], row[1]);// 输出查询到的用户名和密码
-        string password(row[1]);// 数据库中存储的密码
-        /* 登录行为*/
-        if(isLogin){
-            if(pwd == password){flag = true;}// 密码匹配：验证成功
-            else{
-                flag = false;// 密码不匹配：验证失败
-                LOG_DEBUG("pwd error!");
+    UserStore* store = UserStore::Instance();
+    if(!store){return false;}
+    if(known){// 过滤器判定不存在的用户名直接注册
+        string stored;// 存储中的密码
+        UserStore::RESULT res = store->Find(name, &stored);
+        if(res == UserStore::ERROR){return false;}// 查询失败直接返回false
+        if(res == UserStore::FOUND){
+            cache->Put(name, stored);// 放入缓存，下次不用查
+            /* 登录行为*/
+            if(isLogin){
+                if(pwd == stored){flag = true;}// 密码匹配：验证成功
+                else{LOG_DEBUG("pwd error!");}// 密码不匹配：验证失败
+            }else{
+                // 注册行为：查到用户名存在 → 标记为false（用户名已被占用）
+                flag = false;
+                LOG_DEBUG("user used!");
             }
-        }else{
-            // 注册行为：查到用户名存在 → 标记为false（用户名已被占用）
-            flag = false;
-            LOG_DEBUG("user used!");
         }
     }
-    // 释放结果集资源
-    mysql_free_result(res);
 
     /* 注册行为 且 用户名未被使用*/
     if(!isLogin && flag == true){
         LOG_DEBUG("register!");
-        bzero(order, 256);// 清空SQL缓冲区
-        // 构造插入SQL：新增用户记录
-        snprintf(order, 256,"INSERT INTO user(username, password) VALUES('%s','%s')", name.c_str(), pwd.c_str());
-        LOG_DEBUG( "%s", order);
-        if(mysql_query(sql, order)) { // 执行插入
-            LOG_DEBUG( "Insert error!");// 插入失败（如主键冲突）
-            flag = false; 
+        flag = store->Insert(name, pwd);
+        if(flag){
+            cache->Put(name, pwd);// 写穿：新用户立即可从缓存登录，注册同名直接拒绝
         }
-        flag = true;// 插入成功：注册成功
     }
-    SqlConnPool::Instance()->FreeConn(sql);// 归还数据库连接到连接池
     LOG_DEBUG( "UserVerify success!!");// 日志标记验证流程结束
     return flag;// 返回最终验证结果
 }
@@ -304,6 +341,14 @@ std::string HttpRequest::GetPost(const char* key) const {
     return "";
 }
 
+std::string HttpRequest::GetHeader(const std::string& key) const {
+    assert(key != "");
+    if(header_.count(key) == 1) {
+        return header_.find(key)->second;
+    }
+    return "";
+}
+
 HttpRequest::PARSE_STATE HttpRequest::state() const {
     return state_;
 }
\ No newline at end of file
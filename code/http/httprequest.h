@@ -6,12 +6,12 @@
 #include <string>
 #include <regex> //处理字符串和正则匹配（HTTP 解析常用）
 #include <errno.h> //错误码处理
-#include <mysql/mysql.h> 
 
 #include "../buffer/buffer.h"
 #include "../log/log.h"
-#include "../pool/sqlconnpool.h"
-#include "../pool/sqlconnRAII.h"
+#include "../pool/usercache.h"
+#include "../pool/userstore.h"
+#include "sessionstore.h"
 
 class HttpRequest{
 public:
@@ -62,12 +62,25 @@ public:
     //获取 POST 请求的参数（支持string/char*键）
     std::string GetPost(const std::string& key) const;
     std::string GetPost(const char* key) const;
+    //获取请求头部字段（不存在返回空串）
+    std::string GetHeader(const std::string& key) const;
 
     PARSE_STATE state() const;
 
     //判断是否为长连接
     bool IsKeepAlive() const;
 
+    //请求是否要访问数据库（登录/注册表单），WebServer 据此把它派给阻塞通道
+    bool IsBlocking() const;
+    //处理 POST 表单：登录/注册会同步查询用户存储，只应在阻塞通道的线程里调用
+    void HandlePost();
+    //异步验证用：解析登录/注册表单，取出用户名、密码和是否为登录（不是登录/注册表单返回 false）
+    bool LoginForm(std::string* name, std::string* pwd, bool* isLogin);
+    //写入验证结果：成功跳转欢迎页并新建会话，失败跳转错误页
+    void SetVerified(bool ok);
+    //本次响应要下发的会话 Cookie 值（登录/注册成功时新建，会话命中续期时为原值），没有返回空串
+    const std::string& NewSession() const { return session_; }
+
 private:
     //解析请求行（提取方法、路径、版本）
     bool ParseRequestLine_(const std::string& line);
@@ -82,8 +95,10 @@ private:
     void ParsePost_();
     //解析 URL 编码的 POST 参数（如username=abc&pwd=123）
     void ParseFromUrlencoded_();
+    //快速路径：登录请求带有同一用户的有效会话 Cookie 时直接跳转欢迎页，不查数据库
+    void CheckSession_();
 
-    //静态函数，验证用户名密码（结合 MySQL 数据库）
+    //静态函数，验证用户名密码（经 UserStore 访问所配置的用户存储后端）
     static bool UserVerify(const std::string& name, const std::string& pwd, bool isLogin);
 
     //当前解析状态（状态机的核心）
@@ -94,6 +109,8 @@ private:
     std::unordered_map<std::string, std::string> header_;
     //哈希表，存储 POST 参数（键值对，如username: admin）
     std::unordered_map<std::string, std::string> post_;
+    //登录/注册成功后新建的会话 Cookie 值
+    std::string session_;
 
     //无序集合，存储默认 HTML 页面（如/index.html//login.html）
     static const std::unordered_set<std::string> DEFAULT_HTML;
@@ -2,42 +2,74 @@
 
 using namespace std;
 
+/* 以下响应头片段全部是编译期拼好的字符串常量，长度由 sizeof 得到，生成响应时只需 memcpy */
+#define FRAGMENT(str) {str, sizeof(str) - 1}
+#define KEEP_ALIVE_LINES "Connection: keep-alive\r\nkeep-alive: max=6, timeout=120\r\n"
+#define CLOSE_LINES "Connection: close\r\n"
+//状态行 + Connection 头，长连接和短连接各一份
+#define STATUS_LINE(code, status) \
+    {code, status, FRAGMENT("HTTP/1.1 " #code " " status "\r\n" KEEP_ALIVE_LINES), \
+                   FRAGMENT("HTTP/1.1 " #code " " status "\r\n" CLOSE_LINES)}
+//后缀 -> 完整的 Content-type 头
+#define MIME_TYPE(suffix, type) {suffix, sizeof(suffix) - 1, type, FRAGMENT("Content-type: " type "\r\n")}
+
+//根据数字状态码（如 200, 404）获取对应的状态行（如 "HTTP/1.1 404 Not Found"）
+constexpr HttpResponse::StatusLine HttpResponse::STATUS_LINE[] = {
+    STATUS_LINE(200, "OK"),
+    STATUS_LINE(400, "Bad Request"),
+    STATUS_LINE(403, "Forbidden"),
+    STATUS_LINE(404, "Not Found"),
+    STATUS_LINE(503, "Service Unavailable"),
+};
+
 //根据文件的后缀名（如 .html, .jpg），决定 HTTP 响应头中的 Content-Type。
-const unordered_map<string, string> HttpResponse::SUFFIX_TYPE = {
-    {".html", "text/html"},
-    {".xml", "text/xml"},
-    {".xhtml", "application/xhtml+xml"},
-    {".txt", "text/plain"},
-    {".rtf", "application/rtf"},
-    {".pdf", "application/pdf"},
-    {".word", "application/msword"},
-    {".png", "image/png"},
-    {".gif", "image/gif"},
-    {".jpg", "image/jpeg"},
-    {".jpeg", "image/jpeg"},
-    {".au", "audio/basic"},
-    {".mpeg", "video/mpeg"},
-    {".mpg", "video/mpeg"},
-    {".avi", "video/x-msvideo"},
-    {".gz", "application/x-gzip"},
-    {".tar", "application/x-tar"},
-    {".css", "text/css"},
-    {".js", "text/javascript"},
+constexpr HttpResponse::MimeType HttpResponse::SUFFIX_TYPE[] = {
+    MIME_TYPE(".html", "text/html"),
+    MIME_TYPE(".xml", "text/xml"),
+    MIME_TYPE(".xhtml", "application/xhtml+xml"),
+    MIME_TYPE(".txt", "text/plain"),
+    MIME_TYPE(".rtf", "application/rtf"),
+    MIME_TYPE(".pdf", "application/pdf"),
+    MIME_TYPE(".word", "application/msword"),
+    MIME_TYPE(".png", "image/png"),
+    MIME_TYPE(".gif", "image/gif"),
+    MIME_TYPE(".jpg", "image/jpeg"),
+    MIME_TYPE(".jpeg", "image/jpeg"),
+    MIME_TYPE(".au", "audio/basic"),
+    MIME_TYPE(".mpeg", "video/mpeg"),
+    MIME_TYPE(".mpg", "video/mpeg"),
+    MIME_TYPE(".avi", "video/x-msvideo"),
+    MIME_TYPE(".gz", "application/x-gzip"),
+    MIME_TYPE(".tar", "application/x-tar"),
+    MIME_TYPE(".css", "text/css"),
+    MIME_TYPE(".js", "text/javascript"),
 };
 
-//根据数字状态码（如 200, 404）获取对应的英文描述（如 "OK", "Not Found"）
-const unordered_map<int,string> HttpResponse::CODE_STATUE = {
-    { 200, "OK"},
-    { 400, "Bad Request"},
-    { 403, "Forbidden"},
-    { 404, "Not Found"},
+//没有后缀或后缀未知时使用
+constexpr HttpResponse::MimeType HttpResponse::DEFAULT_TYPE = MIME_TYPE("", "text/plain");
+//错误页使用
+constexpr HttpResponse::MimeType HttpResponse::DEFAULT_HTML_TYPE = MIME_TYPE(".html", "text/html");
+
+//Content-Encoding 头，下标为 Compressor::ENCODING
+constexpr HttpResponse::Fragment HttpResponse::ENCODING_HEADER[] = {
+    FRAGMENT(""),
+    FRAGMENT("Content-Encoding: deflate\r\n"),
+    FRAGMENT("Content-Encoding: gzip\r\n"),
 };
 
-//当发生 400/403/404 错误时，服务器不返回原本请求的文件，而是自动重定向到这些预定义的 HTML 错误页面
+constexpr HttpResponse::Fragment HttpResponse::VARY_HEADER = FRAGMENT("Vary: Accept-Encoding\r\n");
+
+std::atomic<uint64_t> HttpResponse::date_[DATE_WORDS];
+std::atomic<uint32_t> HttpResponse::dateSeq_(0);
+time_t HttpResponse::dateSec_ = 0;
+shared_ptr<const HttpResponse::ErrorPageMap> HttpResponse::errorPages_;
+
+//当发生 400/403/404/503 错误时，服务器不返回原本请求的文件，而是自动重定向到这些预定义的 HTML 错误页面
 const unordered_map<int,string> HttpResponse::CODE_PATH = {
     { 400, "/400.html"},
     { 403, "/403.html"},
     { 404, "/404.html"},
+    { 503, "/503.html"},
 };
 //初始化成员变量
 HttpResponse::HttpResponse(){
@@ -46,26 +78,43 @@ HttpResponse::HttpResponse(){
     isKeepAlive_ = false;
     mmFile_ = nullptr;
     mmFileStat_ = {0};
+    encoding_ = Compressor::IDENTITY;
+    bundleFile_ = nullptr;
+    bundleFileLen_ = 0;
+    deferCompress_ = false;
+    pendingZip_ = false;
 }
 //确保释放内存映射资源，防止内存泄漏
 HttpResponse::~HttpResponse(){
     UnmapFile();
 }
 //重置对象状态。因为服务器通常使用对象池或重复利用对象来处理多个请求，所以在处理新请求前必须清空旧数据（如 mmFile_ 指针、状态码等）
-void HttpResponse::Init(const string& srcDir, string& path, bool isKeepAlive, int code){
+void HttpResponse::Init(const string& srcDir, string& path, bool isKeepAlive, int code,
+                        Compressor::ENCODING encoding){
     assert(srcDir != "");
     if(mmFile_) { UnmapFile(); }
+    memFile_.reset();
+    encoding_ = encoding;
     code_ = code;
     isKeepAlive_ = isKeepAlive;
+    session_.clear();
     path_ = path;
     srcDir_ = srcDir;
     mmFile_ = nullptr;
     mmFileStat_ = {0};
+    bundleFile_ = nullptr;
+    bundleFileLen_ = 0;
+    deferCompress_ = false;
+    pendingZip_ = false;
 }
 //这是生成响应的主入口函数
 void HttpResponse::MakeResponse(Buffer& buff){
     /* 判断请求的资源文件 */
     
+    //开启资源包时先查包内索引，命中则不再访问文件系统；未命中（如部署后新增的文件）再走磁盘
+    if (code_ < 400 && AddBundleContent_(buff)) {
+        return;
+    }
     //系统调用 stat 会读取磁盘上的文件元数据（大小、权限、类型等）并写入 mmFileStat_
     if (code_ < 400) { 
         if (stat((srcDir_ + path_).data(), &mmFileStat_) < 0 || S_ISDIR(mmFileStat_.st_mode)) {
@@ -78,6 +127,10 @@ void HttpResponse::MakeResponse(Buffer& buff){
             code_ = 200; // 文件存在且可读，确认状态为 200
         }
     }
+    //错误响应优先使用内存中的错误页，不再 stat/open/mmap
+    if(code_ >= 400 && AddErrorPage_(buff)){
+        return;
+    }
     //如果状态码是错误的（如 404），将 path_ 修改为对应的错误页面路径（如 /404.html）
     ErrorHtml_();
     //构建响应报文：依次调用以下三个函数向 Buffer 中写入数据
@@ -87,41 +140,239 @@ void HttpResponse::MakeResponse(Buffer& buff){
 }
 
 char* HttpResponse::File(){
+    if(memFile_) { return const_cast<char*>(memFile_->data()); }
+    if(bundleFile_) { return const_cast<char*>(bundleFile_); }
     return mmFile_;
 }
 
 size_t HttpResponse::FileLen() const{
+    if(memFile_) { return memFile_->size(); }
+    if(bundleFile_) { return bundleFileLen_; }
     return mmFileStat_.st_size;
 }
 
+function<void()> HttpResponse::ColdFileLoader() const{
+    if(pendingZip_){
+        /* 压缩本身就要读完整个文件，读盘和压缩一起在磁盘 I/O 线程完成 */
+        string file = srcDir_ + path_, path = path_;
+        time_t mtime = mmFileStat_.st_mtime;
+        Compressor::ENCODING enc = encoding_;
+        return [file, path, mtime, enc]{ CompressCold_(file, path, mtime, enc); };
+    }
+    if(memFile_) { return nullptr; }
+    if(bundleFile_){
+        if(bundleFileLen_ < PageCache::COLD_CHECK_SIZE || PageCache::IsResident(bundleFile_, bundleFileLen_)){
+            return nullptr;
+        }
+        /* 资源包映射与进程同寿命，可以直接逐页访问 */
+        const char* data = bundleFile_;
+        size_t len = bundleFileLen_;
+        return [data, len]{ PageCache::Touch(data, len); };
+    }
+    size_t len = mmFileStat_.st_size;
+    if(!mmFile_ || len < PageCache::COLD_CHECK_SIZE || PageCache::IsResident(mmFile_, len)){
+        return nullptr;
+    }
+    /* 连接的映射可能随连接关闭被释放，因此重新打开文件读取 */
+    string file = srcDir_ + path_;
+    return [file]{ PageCache::LoadFile(file); };
+}
+
+bool HttpResponse::AddBundleContent_(Buffer& buff){
+    const ResourceBundle::Entry* entry = ResourceBundle::Instance()->Find(path_);
+    if(!entry){
+        return false;
+    }
+    code_ = 200;
+    AddStateLine_(buff);
+    AddDate_(buff);
+    AddSession_(buff);
+    /* 与磁盘路径相同的压缩策略，压缩缓存以包内记录的 mtime 为键 */
+    if(encoding_ != Compressor::IDENTITY && Compressor::ShouldCompress(entry->type, entry->len)){
+        auto zipped = Compressor::Instance()->Get(path_, entry->mtime, encoding_, entry->data, entry->len);
+        if(zipped){
+            const Fragment& type = GetFileType_().header;
+            buff.Append(type.data, type.len);
+            buff.Append(VARY_HEADER.data, VARY_HEADER.len);
+            buff.Append(ENCODING_HEADER[encoding_].data, ENCODING_HEADER[encoding_].len);
+            AddContentLength_(buff, zipped->size());
+            memFile_ = zipped;
+            return true;
+        }
+    }
+    buff.Append(entry->head);
+    bundleFile_ = entry->data;
+    bundleFileLen_ = entry->len;
+    return true;
+}
+
+void HttpResponse::UpdateDate(){
+    time_t now = time(nullptr);
+    if(now == dateSec_) { return; }
+    dateSec_ = now;
+    struct tm t;
+    gmtime_r(&now, &t);
+    char line[DATE_WORDS * 8] = {0};
+    strftime(line, DATE_LEN + 1, "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", &t);
+    /* 顺序锁写端：序号为奇数期间读端的复制一律作废重读 */
+    uint32_t seq = dateSeq_.load(std::memory_order_relaxed);
+    dateSeq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for(size_t i = 0; i < DATE_WORDS; i++){
+        uint64_t word;
+        memcpy(&word, line + i * 8, 8);
+        date_[i].store(word, std::memory_order_relaxed);
+    }
+    dateSeq_.store(seq + 2, std::memory_order_release);
+}
+
+size_t HttpResponse::CopyDate_(char* out){
+    uint32_t begin, end;
+    do{
+        begin = dateSeq_.load(std::memory_order_acquire);
+        for(size_t i = 0; i < DATE_WORDS; i++){
+            uint64_t word = date_[i].load(std::memory_order_relaxed);
+            memcpy(out + i * 8, &word, 8);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        end = dateSeq_.load(std::memory_order_relaxed);
+    }while((begin & 1) || begin != end);
+    return DATE_LEN;
+}
+
+const HttpResponse::StatusLine* HttpResponse::FindStatus_(int code){
+    for(const auto& line : STATUS_LINE){
+        if(line.code == code) { return &line; }
+    }
+    return nullptr;
+}
+
+bool HttpResponse::LoadErrorPages(const string& srcDir){
+    auto pages = make_shared<ErrorPageMap>();
+    bool ok = true;
+    for(const auto& item : CODE_PATH){
+        int code = item.first;
+        string body;
+        /* 启动/重载时读一次文件，之后全部走内存 */
+        int fd = open((srcDir + item.second).data(), O_RDONLY);
+        if(fd >= 0){
+            char chunk[4096];
+            ssize_t n;
+            while((n = read(fd, chunk, sizeof(chunk))) > 0){
+                body.append(chunk, n);
+            }
+            close(fd);
+        }
+        if(body.empty()){
+            LOG_WARN("Error page %s missing, use generated page", item.second.c_str());
+            const StatusLine* line = FindStatus_(code);
+            body = ErrorBody_(code, line ? line->status : "Error");
+            ok = false;
+        }
+
+        ErrorPage& page = (*pages)[code];
+        page.body[Compressor::IDENTITY] = make_shared<const string>(move(body));
+        const string& plain = *page.body[Compressor::IDENTITY];
+        for(int enc = Compressor::IDENTITY; enc <= Compressor::GZIP; enc++){
+            auto zipped = make_shared<string>();
+            if(enc != Compressor::IDENTITY && !(Compressor::ShouldCompress("text/html", plain.size())
+               && Compressor::Compress(plain.data(), plain.size(), static_cast<Compressor::ENCODING>(enc), *zipped))){
+                /* 不值得压缩或压缩失败：该编码下直接发送原文 */
+                page.body[enc] = page.body[Compressor::IDENTITY];
+                page.head[enc] = page.head[Compressor::IDENTITY];
+                continue;
+            }
+            if(enc != Compressor::IDENTITY){
+                page.body[enc] = zipped;
+            }
+            Buffer head(128);
+            head.Append(DEFAULT_HTML_TYPE.header.data, DEFAULT_HTML_TYPE.header.len);
+            head.Append(VARY_HEADER.data, VARY_HEADER.len);
+            head.Append(ENCODING_HEADER[enc].data, ENCODING_HEADER[enc].len);
+            AddContentLength_(head, page.body[enc]->size());
+            page.head[enc] = head.RetrieveAllToStr();
+        }
+    }
+    atomic_store(&errorPages_, shared_ptr<const ErrorPageMap>(pages));
+    LOG_INFO("Error pages loaded: %d", static_cast<int>(pages->size()));
+    return ok;
+}
+
+ssize_t HttpResponse::SendErrorPage(int fd, int code){
+    auto pages = atomic_load(&errorPages_);
+    const StatusLine* line = FindStatus_(code);
+    if(!pages || !line || pages->count(code) == 0){
+        return -1;
+    }
+    const ErrorPage& page = pages->find(code)->second;
+    const string& head = page.head[Compressor::IDENTITY];
+    const string& body = *page.body[Compressor::IDENTITY];
+    char date[DATE_WORDS * 8];
+    struct iovec iov[4];
+    iov[0].iov_base = const_cast<char*>(line->close.data);
+    iov[0].iov_len = line->close.len;
+    iov[1].iov_base = date;
+    iov[1].iov_len = CopyDate_(date);
+    iov[2].iov_base = const_cast<char*>(head.data());
+    iov[2].iov_len = head.size();
+    iov[3].iov_base = const_cast<char*>(body.data());
+    iov[3].iov_len = body.size();
+    return writev(fd, iov, 4);
+}
+
+bool HttpResponse::AddErrorPage_(Buffer& buff){
+    auto pages = atomic_load(&errorPages_);
+    if(!pages){
+        return false;
+    }
+    if(!FindStatus_(code_)){
+        code_ = 400;
+    }
+    auto it = pages->find(code_);
+    if(it == pages->end()){
+        return false;
+    }
+    if(mmFile_) { UnmapFile(); }
+    AddStateLine_(buff);
+    AddDate_(buff);
+    buff.Append(it->second.head[encoding_]);
+    memFile_ = it->second.body[encoding_];
+    return true;
+}
+
+void HttpResponse::AddDate_(Buffer& buff){
+    char date[DATE_WORDS * 8];
+    buff.Append(date, CopyDate_(date));
+}
+
+void HttpResponse::AddSession_(Buffer& buff){
+    if(session_.empty()) { return; }
+    buff.Append("Set-Cookie: " + string(SessionStore::COOKIE_NAME) + "=" + session_ + "; Path=/; Max-Age="
+                + to_string(SessionStore::Instance()->TtlSec()) + "; HttpOnly; SameSite=Lax\r\n");
+}
+
 void HttpResponse::ErrorHtml_(){
     if(CODE_PATH.count(code_) == 1){
         path_ = CODE_PATH.find(code_)->second;
         stat((srcDir_ + path_).data(), &mmFileStat_);
     }
 }
-//(添加状态行)HTTP/1.1 状态码 状态描述\r\n
+//(添加状态行)HTTP/1.1 状态码 状态描述\r\n，与 Connection 头一起作为一个预先拼好的片段写入
 void HttpResponse::AddStateLine_(Buffer& buff){
-    string status;
-    if(CODE_STATUE.count(code_) == 1){
-        status = CODE_STATUE.find(code_)->second;
-    }
-    else{
+    const StatusLine* line = FindStatus_(code_);
+    if(!line){
         code_ = 400;
-        status = CODE_STATUE.find(code_)->second;
+        line = FindStatus_(code_);
     }
-    buff.Append("HTTP/1.1 " + to_string(code_) + " " + status + "\r\n");
+    const Fragment& frag = isKeepAlive_ ? line->keepAlive : line->close;
+    buff.Append(frag.data, frag.len);
 }
-//(添加响应头)
+//(添加响应头)Date 取自事件循环维护的缓存，Content-type 为编译期拼好的整行
 void HttpResponse::AddHeader_(Buffer& buff){
-    buff.Append("Connection: ");
-    if(isKeepAlive_){
-        buff.Append("keep-alive\r\n");
-        buff.Append("keep-alive: max=6, timeout=120\r\n");
-    }else{
-        buff.Append("close\r\n");
-    }
-    buff.Append("Content-type: " + GetFileType_() + "\r\n");
+    AddDate_(buff);
+    AddSession_(buff);
+    const Fragment& type = GetFileType_().header;
+    buff.Append(type.data, type.len);
 }
 //内存映射, 处理大文件传输的核心优化部分
 void HttpResponse::AddContent_(Buffer& buff){
@@ -143,25 +394,135 @@ void HttpResponse::AddContent_(Buffer& buff){
     }
     mmFile_ = (char*)mmRet;
     close(srcFd);
+    //大文件首次映射时提示内核顺序访问并提前预读，减少随后 writev 中的缺页
+    if(static_cast<size_t>(mmFileStat_.st_size) >= PageCache::COLD_CHECK_SIZE){
+        PageCache::Advise(mmFile_, mmFileStat_.st_size);
+    }
+    if(CompressFile_(buff, GetFileType_().type)){
+        return;
+    }
     //写入 Content-length 头，具体的文件数据本身并没有拷贝进 Buffer，而是通过 mmFile_ 指针后续直接发送
-    buff.Append("Content-length: " + to_string(mmFileStat_.st_size) + "\r\n\r\n");
+    AddContentLength_(buff, mmFileStat_.st_size);
 }
 
-string HttpResponse::GetFileType_(){
-    /* 判断文件类型 */
-    string::size_type idx = path_.find_last_of('.');
+void HttpResponse::AddContentLength_(Buffer& buff, size_t len){
+    /* 手写整数转换，避免 to_string 和字符串拼接产生的临时对象 */
+    static const char PREFIX[] = "Content-length: ";
+    char line[sizeof(PREFIX) + 24];
+    char digits[24];
+    int n = 0;
+    do{
+        digits[n++] = '0' + len % 10;
+        len /= 10;
+    } while(len);
+    memcpy(line, PREFIX, sizeof(PREFIX) - 1);
+    char* p = line + sizeof(PREFIX) - 1;
+    while(n) { *p++ = digits[--n]; }
+    memcpy(p, "\r\n\r\n", 4);
+    buff.Append(line, p + 4 - line);
+}
+
+bool HttpResponse::CompressFile_(Buffer& buff, const char* type){
+    if(!Compressor::Compressible(type)){
+        return false;
+    }
+    /* 可压缩的资源无论本次是否压缩都要声明 Vary，避免中间缓存把压缩版本发给不支持的客户端 */
+    buff.Append(VARY_HEADER.data, VARY_HEADER.len);
+    if(encoding_ == Compressor::IDENTITY || !Compressor::ShouldCompress(type, mmFileStat_.st_size)){
+        return false;
+    }
+    auto zipped = Compressor::Instance()->Find(path_, mmFileStat_.st_mtime, encoding_);
+    if(!zipped && deferCompress_){
+        /* 缓存未命中：不占用当前线程压缩，实体头留到 FinishDeferred 再写 */
+        pendingZip_ = true;
+        return true;
+    }
+    if(!zipped){
+        zipped = Compressor::Instance()->Get(path_, mmFileStat_.st_mtime, encoding_, mmFile_, mmFileStat_.st_size);
+    }
+    if(!zipped){
+        return false;
+    }
+    /* 压缩数据已在缓存中，原文件映射不再需要 */
+    UnmapFile();
+    memFile_ = zipped;
+    buff.Append(ENCODING_HEADER[encoding_].data, ENCODING_HEADER[encoding_].len);
+    AddContentLength_(buff, memFile_->size());
+    return true;
+}
+
+void HttpResponse::FinishDeferred(Buffer& buff, bool compressNow){
+    if(!pendingZip_) { return; }
+    pendingZip_ = false;
+    auto zipped = Compressor::Instance()->Find(path_, mmFileStat_.st_mtime, encoding_);
+    if(!zipped && compressNow){
+        zipped = Compressor::Instance()->Get(path_, mmFileStat_.st_mtime, encoding_, mmFile_, mmFileStat_.st_size);
+    }
+    if(!zipped){
+        /* 压缩失败或已被淘汰：原样发送映射的文件 */
+        AddContentLength_(buff, mmFileStat_.st_size);
+        return;
+    }
+    UnmapFile();
+    memFile_ = zipped;
+    buff.Append(ENCODING_HEADER[encoding_].data, ENCODING_HEADER[encoding_].len);
+    AddContentLength_(buff, memFile_->size());
+}
+
+void HttpResponse::CompressCold_(const string& file, const string& path, time_t mtime, Compressor::ENCODING enc){
+    int fd = open(file.c_str(), O_RDONLY);
+    if(fd < 0) { return; }
+    struct stat st;
+    if(fstat(fd, &st) < 0 || st.st_mtime != mtime || st.st_size == 0){
+        close(fd);
+        return;
+    }
+    void* data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) { return; }
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    Compressor::Instance()->Get(path, mtime, enc, static_cast<const char*>(data), st.st_size);
+    munmap(data, st.st_size);
+}
+
+const HttpResponse::MimeType& HttpResponse::GetFileType_() const{
+    return FindMime_(path_);
+}
+
+const HttpResponse::MimeType& HttpResponse::FindMime_(const string& path){
+    /* 判断文件类型：直接在 path 上比较后缀，不再 substr 出临时字符串 */
+    string::size_type idx = path.find_last_of('.');
     if(idx == string::npos){
-        return "text/plain";
+        return DEFAULT_TYPE;
     }
-    string suffix = path_.substr(idx);
-    if(SUFFIX_TYPE.count(suffix) == 1){
-        return SUFFIX_TYPE.find(suffix)->second;
+    size_t len = path.size() - idx;
+    for(const auto& mime : SUFFIX_TYPE){
+        if(mime.suffixLen == len && path.compare(idx, len, mime.suffix) == 0){
+            return mime;
+        }
     }
-    return "text/plain";
+    return DEFAULT_TYPE;
+}
+
+const char* HttpResponse::ContentType(const string& path){
+    return FindMime_(path).type;
 }
 
+string HttpResponse::EntityHead(const string& path, size_t len){
+    const MimeType& mime = FindMime_(path);
+    Buffer head(128);
+    head.Append(mime.header.data, mime.header.len);
+    if(Compressor::Compressible(mime.type)){
+        head.Append(VARY_HEADER.data, VARY_HEADER.len);
+    }
+    AddContentLength_(head, len);
+    return head.RetrieveAllToStr();
+}
 
 void HttpResponse::UnmapFile(){
+    memFile_.reset();
+    bundleFile_ = nullptr;
+    bundleFileLen_ = 0;
     if(mmFile_){
         munmap(mmFile_,mmFileStat_.st_size);
         mmFile_ = nullptr;
@@ -172,19 +533,19 @@ void HttpResponse::UnmapFile(){
 //它是一个“兜底”方案。通常服务器会尝试返回磁盘上的 /404.html 文件，但如果连那个文件读取都出错了，
 // 或者在 mmap 过程中发生了严重错误，这个函数就会被调用，直接在内存中拼写一段 HTML 代码返回。
 void HttpResponse::ErrorContent(Buffer& buff,string message){
+    string body = ErrorBody_(code_, message);
+    /* 错误页只有一百多字节，远小于 Compressor::MIN_SIZE，压缩没有收益，始终原样发送 */
+    AddContentLength_(buff, body.size());
+    buff.Append(body);
+}
+
+string HttpResponse::ErrorBody_(int code, const string& message){
     string body;
-    string status;
+    const StatusLine* line = FindStatus_(code);
     body += "<html><title>Error</title>";
     body += "<body bgcolor=\"ffffff\">";
-    if(CODE_STATUE.count(code_) == 1){
-        status = CODE_STATUE.find(code_)->second;
-    }else{
-        status = "Bad Request";
-    }
-    body += to_string(code_) + " : " + status + "\n";
+    body += to_string(code) + " : " + (line ? line->status : "Bad Request") + "\n";
     body += "<P>" + message + "<P>";
     body += "<hr><em>TinyWebServer</em></body></html>";
-
-    buff.Append("Content-length: " + to_string(body.size()) + "\r\n\r\n");
-    buff.Append(body);
+    return body;
 }
\ No newline at end of file
@@ -6,9 +6,18 @@
 #include <unistd.h>    // 提供close()/read()等系统调用
 #include <sys/stat.h>   // 提供stat结构体/stat()函数（获取文件状态：大小、类型等）
 #include <sys/mman.h>    // 提供mmap()/munmap()（内存映射文件，提升文件读取效率）
+#include <sys/uio.h>     // 提供writev()（直接发送内存错误页）
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <time.h>
 
 #include "../buffer/buffer.h"   // 自定义缓冲区类（用于拼接HTTP响应数据，减少IO次数）
 #include "../log/log.h"         // 自定义日志类（记录响应处理中的错误/信息）
+#include "compressor.h"         // 响应压缩与压缩结果缓存
+#include "resourcebundle.h"     // 资源包（打包后的静态资源）
+#include "pagecache.h"          // 冷文件判断与预读
+#include "sessionstore.h"       // 登录会话（Set-Cookie）
 
 class HttpResponse{
 public:
@@ -17,39 +26,106 @@ public:
     // 析构函数：通常会调用UnmapFile()释放内存映射，避免内存泄漏
     ~HttpResponse();
 
-    //初始化响应对象核心参数
-    void Init(const std::string& srcDir, std::string& path, bool isKeepAlive = false, int code = -1);
+    //初始化响应对象核心参数, encoding 为与客户端协商出的压缩编码
+    void Init(const std::string& srcDir, std::string& path, bool isKeepAlive = false, int code = -1,
+              Compressor::ENCODING encoding = Compressor::IDENTITY);
     //构建完整的 HTTP 响应（状态行 + 响应头 + 响应体），并写入自定义缓冲区buff
     void MakeResponse(Buffer& buff);
     //解除文件的内存映射（调用munmap()），释放mmFile_指向的内存。
     void UnmapFile();
-    //返回内存映射后的文件指针（mmFile_），用于直接读取文件内容。
+    //返回响应体指针：压缩时为缓存中的压缩数据，否则为内存映射后的文件指针（mmFile_）。
     char* File();
-    //返回映射文件的长度（从mmFileStat_.st_size获取），const 表示不修改成员变量。
+    //返回响应体长度：压缩时为压缩后长度，否则为映射文件的长度（mmFileStat_.st_size）。
     size_t FileLen() const;
     //构建错误响应的响应体（如 404 页面内容），写入缓冲区。
     void ErrorContent(Buffer& buff, std::string message);
+    //响应体是不在页缓存中的大文件时，返回一个把它读入页缓存的任务（在磁盘 I/O 线程执行），否则返回空
+    //任务只捕获文件路径或常驻映射区，不引用本对象，连接在此期间关闭也不会访问已释放的映射
+    std::function<void()> ColdFileLoader() const;
+    //有磁盘 I/O 线程时由调用者开启：压缩缓存未命中的文件不在当前线程压缩，而是由 ColdFileLoader 返回的任务
+    //压缩并放入缓存，之后调用 FinishDeferred 补上实体头；在 Init 之后、MakeResponse 之前调用
+    void SetDeferCompress(bool defer) {deferCompress_ = defer;}
+    //补全推迟压缩的响应：缓存命中则改发压缩数据，否则 compressNow 为 true 时就地压缩，为 false 时原样发送
+    void FinishDeferred(Buffer& buff, bool compressNow);
+    //响应附带 Set-Cookie 会话头（value 为空则不附带）；在 Init 之后、MakeResponse 之前调用
+    void SetSession(const std::string& value) {session_ = value;}
     //内联函数，返回当前响应状态码（code_）
     int Code() const {return code_;}
+    //由主线程的事件循环在每次 epoll_wait 返回后调用，秒数变化时重新格式化缓存的 Date 头
+    static void UpdateDate();
+    //启动时（以及收到 SIGHUP 时）把 CODE_PATH 中的错误页连同响应头一起读入内存，之后错误响应不再访问文件系统
+    //文件缺失时用生成的兜底页面代替，返回 false
+    static bool LoadErrorPages(const std::string& srcDir);
+    //在连接建立前直接向 fd 发送内存中的错误页（如服务器繁忙时的 503），并关闭连接语义（Connection: close）
+    static ssize_t SendErrorPage(int fd, int code);
+    //按路径后缀得到 MIME 类型
+    static const char* ContentType(const std::string& path);
+    //静态文件的实体响应头：Content-type [+ Vary] + Content-length + 空行（供资源包预生成）
+    static std::string EntityHead(const std::string& path, size_t len);
 
 
 private:
+    //编译期拼好的响应头片段：data 指向字符串常量，len 为其长度
+    struct Fragment{
+        const char* data;
+        size_t len;
+    };
+    //状态码 -> 状态描述，以及"状态行 + Connection 头"的长连接/短连接两个版本
+    struct StatusLine{
+        int code;
+        const char* status;
+        Fragment keepAlive;
+        Fragment close;
+    };
+    //文件后缀 -> MIME 类型，以及完整的 Content-type 头
+    struct MimeType{
+        const char* suffix;
+        size_t suffixLen;
+        const char* type;
+        Fragment header;
+    };
+
+    //按状态码查找状态行，找不到返回 nullptr
+    static const StatusLine* FindStatus_(int code);
+
     //构建 HTTP 响应的状态行（如HTTP/1.1 200 OK），写入缓冲区。
     void AddStateLine_(Buffer& buff);
     //构建 HTTP 响应的响应头（如Content-Type: text/html、Connection: keep-alive等），写入缓冲区。
     void AddHeader_(Buffer& buff);
     //构建 HTTP 响应的响应体（文件内容或错误页面内容），写入缓冲区。
     void AddContent_(Buffer& buff);
+    //写入 "Content-length: N\r\n\r\n"（响应头结束）
+    static void AddContentLength_(Buffer& buff, size_t len);
+    //文件类型可压缩且客户端支持时，用压缩缓存中的数据替换 mmFile_ 作为响应体，成功返回 true
+    bool CompressFile_(Buffer& buff, const char* type);
 
-    //	根据状态码（如 404、500）定位错误页面的路径（如/404.html）。
+    //错误状态码命中内存错误页时，写入状态行和预先生成的响应头，并让 memFile_ 指向页面内容，成功返回 true
+    bool AddErrorPage_(Buffer& buff);
+    //写入缓存的 Date 头
+    void AddDate_(Buffer& buff);
+    //复制一份完整的 Date 头到 out（容量 DATE_WORDS * 8），返回长度 DATE_LEN
+    static size_t CopyDate_(char* out);
+    //写入 Set-Cookie 会话头（有新会话时）
+    void AddSession_(Buffer& buff);
+    //	根据状态码（如 404、500）定位错误页面的路径（如/404.html）。内存错误页未加载时使用
     void ErrorHtml_();
+    //生成简易错误页面的 HTML
+    static std::string ErrorBody_(int code, const std::string& message);
     //根据文件后缀（如.html、.css）获取对应的 MIME 类型（如text/html）。
-    std::string GetFileType_();
+    const MimeType& GetFileType_() const;
+    static const MimeType& FindMime_(const std::string& path);
+    //资源包命中时：状态行 + Date + 预生成的实体头，响应体直接指向包的映射区，成功返回 true
+    bool AddBundleContent_(Buffer& buff);
+    //在磁盘 I/O 线程中读取文件并压缩放入缓存（文件在此期间被修改则放弃）
+    static void CompressCold_(const std::string& file, const std::string& path, time_t mtime,
+                              Compressor::ENCODING enc);
 
     //HTTP 响应状态码（200 = 成功、404 = 文件不存在、500 = 服务器内部错误等）
     int code_;
     //是否保持 TCP 长连接（决定响应头Connection的值是keep-alive还是close）。
     bool isKeepAlive_;
+    //新建会话的 Cookie 值（登录/注册成功时）
+    std::string session_;
 
     //请求文件的完整路径
     std::string path_;
@@ -61,12 +137,48 @@ private:
     //文件状态结构体（存储文件大小、是否为普通文件、修改时间等）。
     struct stat mmFileStat_;
 
-    //文件后缀→MIME 类型映射（如.html→text/html; charset=utf-8、.jpg→image/jpeg）
-    static const std::unordered_map<std::string, std::string> SUFFIX_TYPE;
-    //状态码→状态描述映射（如 200→OK、404→Not Found、500→Internal Server Error）
-    static const std::unordered_map<int, std::string> CODE_STATUE;
+    //客户端接受的压缩编码（IDENTITY 表示不压缩）
+    Compressor::ENCODING encoding_;
+    //资源包中的响应体：指向包的映射区，生命周期与进程相同，不需要 munmap
+    const char* bundleFile_;
+    size_t bundleFileLen_;
+    //内存中的响应体（压缩缓存中的数据或内存错误页），非空时代替 mmFile_ 发送；与缓存共享持有
+    std::shared_ptr<const std::string> memFile_;
+    //见 SetDeferCompress；pendingZip_ 表示压缩已推迟，实体头还没有写入
+    bool deferCompress_;
+    bool pendingZip_;
+
+    //文件后缀→MIME 类型映射（如.html→text/html、.jpg→image/jpeg），编译期常量表
+    static const MimeType SUFFIX_TYPE[];
+    static const MimeType DEFAULT_TYPE;
+    static const MimeType DEFAULT_HTML_TYPE;
+    //状态码→状态行（如 200→HTTP/1.1 200 OK），编译期常量表
+    static const StatusLine STATUS_LINE[];
+    //压缩编码→Content-Encoding 头，下标为 Compressor::ENCODING
+    static const Fragment ENCODING_HEADER[];
+    static const Fragment VARY_HEADER;
     //状态码→错误页面路径映射（如 404→/404.html、500→/500.html)
     static const std::unordered_map<int, std::string> CODE_PATH;
+
+    //内存中的错误页：下标为 Compressor::ENCODING，每种编码各一份响应体及其响应头
+    //（Content-type 到空行为止，状态行与 Date 在发送时拼接）
+    struct ErrorPage{
+        std::shared_ptr<const std::string> body[3];
+        std::string head[3];
+    };
+    typedef std::unordered_map<int, ErrorPage> ErrorPageMap;
+    //重新加载时整体替换，读写都通过 std::atomic_load/atomic_store，正在发送的连接通过 memFile_ 持有旧页面
+    static std::shared_ptr<const ErrorPageMap> errorPages_;
+
+    //"Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n" 的固定长度
+    static const size_t DATE_LEN = 37;
+    //Date 头按 8 字节原子字存放，用顺序锁保护：主线程写之前把 dateSeq_ 加成奇数、写完加成偶数，
+    //工作线程复制前后读到的序号相同且为偶数才算读到完整的一行，否则重读
+    static const size_t DATE_WORDS = (DATE_LEN + 7) / 8;
+    static std::atomic<uint64_t> date_[DATE_WORDS];
+    static std::atomic<uint32_t> dateSeq_;
+    //最近一次格式化时的秒数，只由主线程访问
+    static time_t dateSec_;
 };
 
 #endif //HTTP_RESPONSE_H
\ No newline at end of file
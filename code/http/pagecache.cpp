@@ -0,0 +1,80 @@
+#include "pagecache.h"
+
+using namespace std;
+
+size_t PageCache::PageSize_(){
+    static const size_t pageSize = sysconf(_SC_PAGESIZE);
+    return pageSize;
+}
+
+size_t PageCache::Prewarm(const string& dir){
+    size_t total = 0;
+    DIR* dp = opendir(dir.c_str());
+    if(!dp){
+        LOG_WARN("Prewarm: open dir %s error!", dir.c_str());
+        return 0;
+    }
+    struct dirent* ent;
+    while((ent = readdir(dp)) != nullptr){
+        if(ent->d_name[0] == '.') { continue; }
+        string file = dir + "/" + ent->d_name;
+        struct stat st;
+        if(stat(file.c_str(), &st) < 0) { continue; }
+        if(S_ISDIR(st.st_mode)){
+            total += Prewarm(file);
+        }
+        else if(S_ISREG(st.st_mode)){
+            int fd = open(file.c_str(), O_RDONLY);
+            if(fd < 0) { continue; }
+            /* readahead 只发起预读，不会把数据拷贝到用户态 */
+            readahead(fd, 0, st.st_size);
+            close(fd);
+            total += st.st_size;
+        }
+    }
+    closedir(dp);
+    return total;
+}
+
+bool PageCache::IsResident(const void* addr, size_t len){
+    if(!addr || len == 0) { return true; }
+    size_t pageSize = PageSize_();
+    uintptr_t begin = reinterpret_cast<uintptr_t>(addr) & ~(pageSize - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(addr) + len;
+    size_t pages = (end - begin + pageSize - 1) / pageSize;
+    vector<unsigned char> vec(pages);
+    if(mincore(reinterpret_cast<void*>(begin), end - begin, vec.data()) < 0){
+        return true;    // 判断失败时按热文件处理，保持原有行为
+    }
+    for(unsigned char v : vec){
+        if(!(v & 1)) { return false; }
+    }
+    return true;
+}
+
+void PageCache::LoadFile(const string& file){
+    int fd = open(file.c_str(), O_RDONLY);
+    if(fd < 0) { return; }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    static thread_local char chunk[128 * 1024];
+    off_t offset = 0;
+    ssize_t n;
+    while((n = pread(fd, chunk, sizeof(chunk), offset)) > 0){
+        offset += n;
+    }
+    close(fd);
+}
+
+void PageCache::Touch(const void* addr, size_t len){
+    const volatile char* p = static_cast<const volatile char*>(addr);
+    size_t pageSize = PageSize_();
+    for(size_t i = 0; i < len; i += pageSize){
+        (void)p[i];
+    }
+    if(len) { (void)p[len - 1]; }
+}
+
+void PageCache::Advise(void* addr, size_t len){
+    madvise(addr, len, MADV_SEQUENTIAL);
+    madvise(addr, len, MADV_WILLNEED);
+}
@@ -0,0 +1,39 @@
+#ifndef PAGE_CACHE_H
+#define PAGE_CACHE_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/mman.h>   // mincore/madvise
+
+#include "../log/log.h"
+
+// 页缓存辅助：避免工作线程在 writev 中因为 mmap 的文件不在页缓存而发生缺页阻塞。
+//   - Prewarm：启动时把资源目录读进页缓存
+//   - IsResident：用 mincore 判断一段映射是否已全部在内存中
+//   - LoadFile / Touch：在独立的磁盘 I/O 线程里把冷文件读入页缓存
+class PageCache{
+public:
+    // 递归预读 dir 下所有普通文件（readahead），返回预读的字节数
+    static size_t Prewarm(const std::string& dir);
+    // [addr, addr + len) 对应的页是否全部驻留内存；addr 不要求页对齐
+    static bool IsResident(const void* addr, size_t len);
+    // 打开文件并顺序读一遍，读完即在页缓存中（阻塞，只应在磁盘 I/O 线程调用）
+    static void LoadFile(const std::string& file);
+    // 逐页访问一段常驻映射（如资源包），触发缺页把数据读入（阻塞）
+    static void Touch(const void* addr, size_t len);
+    // 首次映射文件时的访问提示：顺序访问 + 尽快预读
+    static void Advise(void* addr, size_t len);
+
+    // 小于该大小的文件不做冷热判断，mincore 的开销反而更大
+    static const size_t COLD_CHECK_SIZE = 256 * 1024;
+
+private:
+    static size_t PageSize_();
+};
+
+#endif //PAGE_CACHE_H
@@ -0,0 +1,213 @@
+#include "resourcebundle.h"
+#include "httpresponse.h"
+
+using namespace std;
+
+const char ResourceBundle::MAGIC[8] = {'W', 'S', 'B', 'U', 'N', 'D', 'L', '1'};
+
+ResourceBundle::ResourceBundle(): base_(nullptr), size_(0) {}
+
+ResourceBundle::~ResourceBundle(){
+    Close();
+}
+
+ResourceBundle* ResourceBundle::Instance(){
+    static ResourceBundle inst;
+    return &inst;
+}
+
+void ResourceBundle::Walk_(const string& dir, const string& urlPrefix, vector<FileInfo>& files){
+    DIR* dp = opendir(dir.c_str());
+    if(!dp){
+        LOG_WARN("Bundle: open dir %s error!", dir.c_str());
+        return;
+    }
+    struct dirent* ent;
+    while((ent = readdir(dp)) != nullptr){
+        if(ent->d_name[0] == '.') { continue; }    // 跳过 . .. 以及 .DS_Store 等隐藏文件
+        string file = dir + "/" + ent->d_name;
+        string url = urlPrefix + "/" + ent->d_name;
+        /* 用 lstat 并跳过符号链接：避免链接成环时无限递归，也不会把 srcDir 之外的文件打进包，
+           这类文件仍由磁盘路径按原逻辑处理 */
+        struct stat st;
+        if(lstat(file.c_str(), &st) < 0 || S_ISLNK(st.st_mode)) { continue; }
+        if(S_ISDIR(st.st_mode)){
+            Walk_(file, url, files);
+        }
+        else if(S_ISREG(st.st_mode) && (st.st_mode & S_IROTH)){
+            files.push_back({url, file, st.st_size, st.st_mtime});
+        }
+    }
+    closedir(dp);
+}
+
+bool ResourceBundle::Pack(const string& srcDir, const string& bundleFile){
+    string root = srcDir;
+    while(root.size() > 1 && root.back() == '/') { root.pop_back(); }
+    vector<FileInfo> files;
+    Walk_(root, "", files);
+
+    /* 先算出索引大小，确定每个文件在包内的偏移 */
+    size_t offset = sizeof(MAGIC) + 2 * sizeof(uint32_t);
+    for(const auto& f : files){
+        offset += 2 * sizeof(uint32_t) + 3 * sizeof(uint64_t) + f.path.size();
+    }
+    vector<uint64_t> offsets;
+    for(const auto& f : files){
+        offset = (offset + ALIGN - 1) / ALIGN * ALIGN;
+        offsets.push_back(offset);
+        offset += f.size;
+    }
+
+    /* 写入临时文件后 rename，避免运行中的进程看到写了一半的包 */
+    string tmpFile = bundleFile + ".tmp";
+    FILE* fp = fopen(tmpFile.c_str(), "wb");
+    if(!fp){
+        LOG_ERROR("Bundle: create %s error!", tmpFile.c_str());
+        return false;
+    }
+    bool ok = true;
+    /* 任何一次写入不完整（如磁盘已满）都放弃整个包 */
+    auto put = [&](const void* data, size_t len){
+        if(ok && fwrite(data, 1, len, fp) != len) { ok = false; }
+    };
+    uint32_t count = files.size(), reserved = 0;
+    put(MAGIC, sizeof(MAGIC));
+    put(&count, sizeof(count));
+    put(&reserved, sizeof(reserved));
+    for(size_t i = 0; i < files.size(); i++){
+        uint32_t pathLen = files[i].path.size();
+        uint64_t len = files[i].size;
+        int64_t mtime = files[i].mtime;
+        put(&pathLen, sizeof(pathLen));
+        put(&reserved, sizeof(reserved));
+        put(&offsets[i], sizeof(uint64_t));
+        put(&len, sizeof(len));
+        put(&mtime, sizeof(mtime));
+        put(files[i].path.data(), pathLen);
+    }
+    char chunk[65536];
+    for(size_t i = 0; i < files.size() && ok; i++){
+        long pos = ftell(fp);
+        static const char ZERO[ALIGN] = {0};
+        if(pos < 0 || static_cast<uint64_t>(pos) > offsets[i]){
+            ok = false;
+            break;
+        }
+        put(ZERO, offsets[i] - pos);
+        int fd = open(files[i].file.c_str(), O_RDONLY);
+        if(fd < 0){
+            LOG_ERROR("Bundle: open %s error!", files[i].file.c_str());
+            ok = false;
+            break;
+        }
+        off_t left = files[i].size;
+        ssize_t n;
+        while(left > 0 && (n = read(fd, chunk, sizeof(chunk))) > 0){
+            n = min<off_t>(n, left);
+            put(chunk, n);
+            left -= n;
+        }
+        close(fd);
+        /* 打包过程中文件被截断：补零保持偏移正确，下次打包时修正 */
+        while(left > 0){
+            size_t z = min<off_t>(left, sizeof(chunk));
+            memset(chunk, 0, z);
+            put(chunk, z);
+            left -= z;
+        }
+    }
+    if(fclose(fp) != 0) { ok = false; }
+    if(!ok || rename(tmpFile.c_str(), bundleFile.c_str()) < 0){
+        LOG_ERROR("Bundle: write %s error!", bundleFile.c_str());
+        unlink(tmpFile.c_str());
+        return false;
+    }
+    LOG_INFO("Bundle: packed %d files (%zu bytes) into %s", (int)count, (size_t)offset, bundleFile.c_str());
+    return true;
+}
+
+bool ResourceBundle::Open(const string& bundleFile){
+    Close();
+    int fd = open(bundleFile.c_str(), O_RDONLY);
+    if(fd < 0){
+        LOG_ERROR("Bundle: open %s error!", bundleFile.c_str());
+        return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) < 0 || st.st_size < (off_t)(sizeof(MAGIC) + 2 * sizeof(uint32_t))){
+        close(fd);
+        LOG_ERROR("Bundle: %s too small!", bundleFile.c_str());
+        return false;
+    }
+    void* mmRet = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mmRet == MAP_FAILED){
+        LOG_ERROR("Bundle: mmap %s error!", bundleFile.c_str());
+        return false;
+    }
+    base_ = static_cast<char*>(mmRet);
+    size_ = st.st_size;
+
+    const char* p = base_;
+    const char* end = base_ + size_;
+    uint32_t count;
+    if(memcmp(p, MAGIC, sizeof(MAGIC)) != 0){
+        LOG_ERROR("Bundle: %s bad magic!", bundleFile.c_str());
+        Close();
+        return false;
+    }
+    p += sizeof(MAGIC);
+    memcpy(&count, p, sizeof(count));
+    p += 2 * sizeof(uint32_t);
+
+    index_.reserve(count);
+    for(uint32_t i = 0; i < count; i++){
+        uint32_t pathLen;
+        uint64_t offset, len;
+        int64_t mtime;
+        if(p + 2 * sizeof(uint32_t) + 3 * sizeof(uint64_t) > end) { break; }
+        memcpy(&pathLen, p, sizeof(pathLen));
+        p += 2 * sizeof(uint32_t);
+        memcpy(&offset, p, sizeof(offset));
+        p += sizeof(offset);
+        memcpy(&len, p, sizeof(len));
+        p += sizeof(len);
+        memcpy(&mtime, p, sizeof(mtime));
+        p += sizeof(mtime);
+        if(p + pathLen > end || offset + len > size_){
+            LOG_ERROR("Bundle: %s corrupted!", bundleFile.c_str());
+            Close();
+            return false;
+        }
+        string path(p, pathLen);
+        p += pathLen;
+
+        Entry& entry = index_[path];
+        entry.data = base_ + offset;
+        entry.len = len;
+        entry.mtime = mtime;
+        entry.type = HttpResponse::ContentType(path);
+        entry.head = HttpResponse::EntityHead(path, len);
+    }
+    /* 整个包按顺序访问，提示内核提前预读 */
+    madvise(base_, size_, MADV_WILLNEED);
+    LOG_INFO("Bundle: %s mapped, %d files", bundleFile.c_str(), (int)index_.size());
+    return true;
+}
+
+void ResourceBundle::Close(){
+    index_.clear();
+    if(base_){
+        munmap(base_, size_);
+        base_ = nullptr;
+        size_ = 0;
+    }
+}
+
+const ResourceBundle::Entry* ResourceBundle::Find(const string& path) const{
+    if(!base_) { return nullptr; }
+    auto it = index_.find(path);
+    if(it == index_.end()) { return nullptr; }
+    return &it->second;
+}
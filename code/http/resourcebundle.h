@@ -0,0 +1,68 @@
+#ifndef RESOURCE_BUNDLE_H
+#define RESOURCE_BUNDLE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>     // opendir/readdir，遍历资源目录
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "../log/log.h"
+
+// 资源包：把 resources/ 下的所有静态文件打包成一个文件，启动时整体 mmap 一次，
+// 用 URL 路径 -> (偏移, 长度, MIME, 预生成响应头) 的哈希索引直接定位内容。
+// 命中后响应体指向这一块映射区，不再有逐个文件的 stat/open/mmap/munmap。
+//
+// 包格式（本机字节序）：
+//   Header  | magic[8] "WSBUNDL1" | count(u32) | reserved(u32) |
+//   Record  | pathLen(u32) | reserved(u32) | offset(u64) | length(u64) | mtime(i64) | path bytes | ... x count
+//   Data    | 各文件内容，按 ALIGN 字节对齐
+class ResourceBundle{
+public:
+    struct Entry{
+        const char* data;       // 指向映射区中的文件内容
+        size_t len;
+        time_t mtime;
+        const char* type;       // MIME 类型
+        std::string head;       // Content-type [+ Vary] + Content-length + 空行
+    };
+
+    static ResourceBundle* Instance();
+
+    // 打包 srcDir 下所有普通且其他用户可读的文件（不可读的文件留给磁盘路径返回 403）
+    static bool Pack(const std::string& srcDir, const std::string& bundleFile);
+    // 映射资源包并建立索引；只在启动阶段调用，之后索引只读，多线程查找无需加锁
+    bool Open(const std::string& bundleFile);
+    void Close();
+    bool IsOpen() const { return base_ != nullptr; }
+
+    // 按 URL 路径（如 /index.html）查找，未命中返回 nullptr
+    const Entry* Find(const std::string& path) const;
+    size_t Count() const { return index_.size(); }
+
+private:
+    ResourceBundle();
+    ~ResourceBundle();
+
+    struct FileInfo{
+        std::string path;       // URL 路径
+        std::string file;       // 磁盘路径
+        off_t size;
+        time_t mtime;
+    };
+    // 递归收集 dir 下的文件，urlPrefix 为对应的 URL 前缀
+    static void Walk_(const std::string& dir, const std::string& urlPrefix, std::vector<FileInfo>& files);
+
+    static const char MAGIC[8];
+    static const size_t ALIGN = 64;
+
+    char* base_;
+    size_t size_;
+    std::unordered_map<std::string, Entry> index_;
+};
+
+#endif //RESOURCE_BUNDLE_H
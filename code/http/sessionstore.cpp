@@ -0,0 +1,90 @@
+#include "sessionstore.h"
+#include "../pool/keyedhash.h"
+#include <limits.h>
+using namespace std;
+
+const char* SessionStore::COOKIE_NAME = "session";
+
+namespace {
+void ToHex(const unsigned char* data, size_t len, string* out) {
+    static const char HEX[] = "0123456789abcdef";
+    for(size_t i = 0; i < len; i++) {
+        out->push_back(HEX[data[i] >> 4]);
+        out->push_back(HEX[data[i] & 0xf]);
+    }
+}
+}
+
+SessionStore::SessionStore(): ttlMs_(0) {
+    RandomBytes(key_, sizeof(key_));
+}
+
+SessionStore* SessionStore::Instance() {
+    static SessionStore store;
+    return &store;
+}
+
+void SessionStore::Init(int ttlSec) {
+    ttlMs_ = ttlSec > 0 ? ttlSec * 1000 : 0;
+}
+
+string SessionStore::Sign_(const string& id) const {
+    uint64_t h = SipHash(key_, id.data(), id.size());
+    unsigned char bytes[8];
+    for(int i = 0; i < 8; i++) { bytes[i] = static_cast<unsigned char>(h >> (8 * i)); }
+    string sig;
+    ToHex(bytes, sizeof(bytes), &sig);
+    return sig;
+}
+
+SessionStore::Stripe& SessionStore::StripeOf_(const string& id) {
+    return stripes_[hash<string>()(id) % STRIPE_COUNT];
+}
+
+string SessionStore::Create(const string& user) {
+    if(!Enabled()) { return ""; }
+    unsigned char rnd[ID_LEN / 2];
+    RandomBytes(rnd, sizeof(rnd));
+    string id;
+    ToHex(rnd, sizeof(rnd), &id);
+
+    Stripe& stripe = StripeOf_(id);
+    {
+        lock_guard<mutex> locker(stripe.mtx);
+        stripe.timer.tick();
+        int timerId = stripe.nextTimerId;
+        stripe.nextTimerId = timerId == INT_MAX ? 0 : timerId + 1;  // 先判断再加，避免有符号溢出
+        stripe.sessions[id] = Session{user, timerId};
+        /* 回调在持有分片锁的 tick 中执行 */
+        stripe.timer.add(timerId, ttlMs_, [&stripe, id] { stripe.sessions.erase(id); });
+    }
+    return id + "." + Sign_(id);
+}
+
+bool SessionStore::Check(const string& cookie, string* user) {
+    assert(user);
+    if(!Enabled() || cookie.size() != ID_LEN + 1 + SIG_LEN || cookie[ID_LEN] != '.') { return false; }
+    string id = cookie.substr(0, ID_LEN);
+    string sig = Sign_(id);
+    /* 定长比较，不因提前返回泄露签名前缀 */
+    unsigned char diff = 0;
+    for(size_t i = 0; i < SIG_LEN; i++) { diff |= sig[i] ^ cookie[ID_LEN + 1 + i]; }
+    if(diff) { return false; }
+
+    Stripe& stripe = StripeOf_(id);
+    lock_guard<mutex> locker(stripe.mtx);
+    stripe.timer.tick();
+    auto it = stripe.sessions.find(id);
+    if(it == stripe.sessions.end()) { return false; }
+    *user = it->second.user;
+    stripe.timer.adjust(it->second.timerId, ttlMs_);    // 续期
+    return true;
+}
+
+void SessionStore::Tick() {
+    if(!Enabled()) { return; }
+    for(Stripe& stripe : stripes_) {
+        lock_guard<mutex> locker(stripe.mtx);
+        stripe.timer.tick();
+    }
+}
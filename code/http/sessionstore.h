@@ -0,0 +1,64 @@
+#ifndef SESSION_STORE_H
+#define SESSION_STORE_H
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <stdint.h>
+
+#include "../log/log.h"
+#include "../timer/heaptimer.h"
+
+// 登录会话：登录/注册成功后下发 Cookie（session=<id>.<签名>），之后同一用户的登录请求在解析阶段
+// 直接识别，不再查数据库。
+//   - id 为 128 位随机数；签名为以启动时随机生成的密钥对 id 做的 SipHash-2-4，伪造的 Cookie 不加锁即可拒绝
+//   - 会话表按 id 分片加锁（lock striping），每片一个 HeapTimer 管理过期：访问时续期，
+//     到期回调删除会话；分片被访问时以及事件循环每秒调用 Tick 时执行到期的定时器
+// 会话只在本进程内存中，重启后全部失效。
+class SessionStore {
+public:
+    static SessionStore* Instance();
+
+    // ttlSec 为会话空闲多久后过期，0 表示关闭会话（Create 返回空串，Check 总是失败）
+    void Init(int ttlSec);
+    bool Enabled() const { return ttlMs_ > 0; }
+    int TtlSec() const { return ttlMs_ / 1000; }
+
+    // 为 user 新建会话，返回 Cookie 值
+    std::string Create(const std::string& user);
+    // 校验 Cookie 值：签名正确且会话未过期时写入 user 并续期，返回 true
+    bool Check(const std::string& cookie, std::string* user);
+    // 执行所有分片中到期的定时器（事件循环线程每秒调用）
+    void Tick();
+
+    static const char* COOKIE_NAME;
+
+private:
+    SessionStore();
+    ~SessionStore() = default;
+
+    struct Session {
+        std::string user;
+        int timerId;
+    };
+    struct Stripe {
+        std::mutex mtx;
+        std::unordered_map<std::string, Session> sessions;  // id -> 会话
+        HeapTimer timer;                                    // 定时器 id -> 会话过期
+        int nextTimerId = 0;
+    };
+
+    // 签名：id 的 SipHash-2-4 值（16 位十六进制）
+    std::string Sign_(const std::string& id) const;
+    Stripe& StripeOf_(const std::string& id);
+
+    static const size_t STRIPE_COUNT = 16;
+    static const size_t ID_LEN = 32;        // 16 字节随机数的十六进制
+    static const size_t SIG_LEN = 16;
+
+    Stripe stripes_[STRIPE_COUNT];
+    uint64_t key_[2];
+    int ttlMs_;
+};
+
+#endif //SESSION_STORE_H
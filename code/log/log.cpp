@@ -1,160 +1,443 @@
 #include "log.h"
+#include <ctype.h>
+#include <stdlib.h>
 using namespace std;
 
-Log::Log():lineCount_(0), isAsync_(false),writeThread_(nullptr),deque_(nullptr),toDay_(0),fp_(nullptr){}
+namespace {
+// 线程退出时把自己的环形缓冲标记为关闭，后台线程取空后释放
+struct RingHolder {
+    LogRing* ring = nullptr;
+    ~RingHolder() { if(ring) { ring->Close(); } }
+};
+thread_local RingHolder t_ring;
+}
+
+Log::Log():lineCount_(0), toDay_(0), isOpen_(false), isAsync_(false), binary_(false), binaryFile_(false),
+    fp_(nullptr), flushMs_(1000), flushBytes_(64 * 1024), lastFlushMs_(0),
+    writeThread_(nullptr), ringSlots_(1024), stop_(false), urgent_(false), fullPolicy_(BLOCK), sampleRate_(10),
+    lastDropReportMs_(0), formatsWritten_(0){
+    SetLevel(1);
+    for(int i = 0; i < LogRing::LEVEL_COUNT; i++){
+        pendingDrops_[i] = 0;
+    }
+}
 Log::~Log(){
     if(writeThread_ && writeThread_->joinable()){
-        while(!deque_->empty()){
-            deque_->flush();
-        };
-        deque_->Close();
-        writeThread_->join();
+        stop_.store(true, memory_order_release);
+        cond_.notify_one();
+        writeThread_->join();   // 后台线程退出前会取空所有环
     }
+    lock_guard<std::mutex> locker(mtx_);
     if(fp_){
-        lock_guard<std::mutex> locker(mtx_);
-        flush();
+        fflush(fp_);
         fclose(fp_);
     }
 }
 
-int Log::GetLevel() {
-    lock_guard<mutex> locker(mtx_);
-    return level_;
-}
-void Log::SetLevel(int level) {
-    lock_guard<mutex> locker(mtx_);
-    level_ = level;
-}
-void Log::init(int level = 1,const char* path,const char* suffix, int maxQueueCapacity){
-    isOpen_ = true;
-    level_ = level;
+void Log::init(int level = 1,const char* path,const char* suffix, int maxQueueCapacity, bool binary){
+    SetLevel(level);
     if(maxQueueCapacity>0){
-        isAsync_ = true;
-        if(!deque_){
-            deque_ = make_unique<BlockDeque<std::string>>();
+        ringSlots_ = maxQueueCapacity;
+        if(!writeThread_){
             writeThread_ = make_unique<std::thread>(FlushLogThread);
         }
-    }else{
-        isAsync_ = false;
     }
-    lineCount_ = 0;
 
-    time_t timer = time(nullptr);
-    struct tm* sysTime = localtime(&timer);
-    struct tm t = *sysTime;
+    long usec;
+    const Clock& now = Now_(&usec);
     path_ = path;
     suffix_ = suffix;
     char fileName[LOG_NAME_LEN] = {0};
-    snprintf(fileName, LOG_NAME_LEN - 1,"%s/%04d_%02d_%02d%s",
-            path_, t.tm_year + 1900, t.tm_mon + 1,t.tm_mday,suffix_);
-    toDay_ = t.tm_mday;
+    snprintf(fileName, LOG_NAME_LEN - 1,"%s/%04d_%02d_%02d%s%s",
+            path_, now.year, now.mon, now.mday, suffix_, binary ? ".bin" : "");
     {
         lock_guard<mutex> locker(mtx_);
-        buff_.RetrieveAll();
+        binaryFile_ = binary;
+        toDay_ = now.mday;
+        lineCount_ = 0;
         if(fp_){
-            flush();
+            fflush(fp_);
             fclose(fp_);
         }
-        fp_ = fopen(fileName,"a");
+        fp_ = OpenFile_(fileName);
         if(fp_ == nullptr){
             mkdir(path_,0777);
-            fp_ = fopen(fileName,"a");
+            fp_ = OpenFile_(fileName);
         }
         assert(fp_ != nullptr);
+        lastFlushMs_ = NowMs_();
     }
+    isAsync_.store(maxQueueCapacity > 0, memory_order_release);
+    binary_.store(binary, memory_order_relaxed);
+    isOpen_.store(true, memory_order_release);
 }
 
 void Log::write(int level, const char* format,...){
-    struct timeval now = {0,0};
-    gettimeofday(&now,nullptr);
-    time_t tSec = now.tv_sec;
-    struct tm* sysTime = localtime(&tSec);
-    struct tm t = *sysTime;
+    /* 异步模式直接格式化进本线程的环形缓冲，不加锁 */
+    char local[LogRing::LINE_SIZE];
+    LogRing* ring;
+    char* line;
+    if(!Claim_(level, &ring, &line)) { return; }
+    if(!line) { line = local; }
+    long usec;
+    const Clock& now = Now_(&usec);
     va_list vaList;
+    va_start(vaList,format);
+    size_t len = Format_(line, now, usec, level, format, vaList);
+    va_end(vaList);
+    Commit_(ring, line, len, logbin::TEXT, level);
+}
 
-    /* 日志日期 日志行数 */
-    if(toDay_ != t.tm_mday || (lineCount_ && (lineCount_ % MAX_LINES == 0))){
-        unique_lock<mutex> locker(mtx_);
-        locker.unlock();
+void Log::SetLevel(int level){
+    for(int i = 0; i < MODULE_COUNT; i++){
+        levels_[i].store(level, memory_order_relaxed);
+    }
+}
 
+const char* Log::ModuleName(int module){
+    static const char* NAMES[] = {"core", "http", "server", "timer", "pool"};
+    return (module >= 0 && module < MODULE_COUNT) ? NAMES[module] : "?";
+}
+
+bool Log::SetModuleLevels(const string& spec){
+    bool ok = true;
+    size_t pos = 0;
+    while(pos < spec.size()){
+        size_t end = spec.find(',', pos);
+        if(end == string::npos) { end = spec.size(); }
+        string item = spec.substr(pos, end - pos);
+        pos = end + 1;
+        if(item.empty()) { continue; }
+        size_t eq = item.find('=');
+        int module = -1;
+        for(int i = 0; eq != string::npos && i < MODULE_COUNT; i++){
+            if(item.compare(0, eq, ModuleName(i)) == 0) { module = i; }
+        }
+        if(module < 0 || eq + 1 >= item.size() || !isdigit((unsigned char)item[eq + 1])){
+            ok = false;
+            continue;
+        }
+        SetModuleLevel(module, atoi(item.c_str() + eq + 1));
+    }
+    return ok;
+}
+
+bool Log::Claim_(int level, LogRing** ring, char** slot){
+    *ring = nullptr;
+    *slot = nullptr;
+    if(!isAsync_.load(memory_order_acquire)) { return true; }
+    LogRing* r = LocalRing_();
+    *ring = r;
+    switch(fullPolicy_){
+    case DROP_OLDEST: {
+        int dropped;
+        *slot = r->ClaimOverwrite(&dropped);
+        if(dropped >= 0) { r->CountDrop(dropped); }
+        if(!*slot){
+            // 要复用的槽位后台线程还没读完：本行丢弃
+            r->CountDrop(level);
+            return false;
+        }
+        return true;
+    }
+    case SAMPLE:
+        if(level < 3 && r->OverHalf() && !r->Sample(sampleRate_)){
+            r->CountDrop(level);
+            return false;
+        }
+        [[fallthrough]];
+    case DROP_NEWEST:
+        *slot = r->Claim();
+        if(!*slot){
+            r->CountDrop(level);
+            cond_.notify_one();
+            return false;
+        }
+        return true;
+    default:
+        while(!(*slot = r->Claim())){
+            // 环满：唤醒后台线程，等它腾出空间
+            cond_.notify_one();
+            this_thread::yield();
+        }
+        return true;
+    }
+}
+
+bool Log::SetFullPolicy(const string& name, int sampleRate){
+    static const char* NAMES[] = {"block", "drop_newest", "drop_oldest", "sample"};
+    for(int i = 0; i < 4; i++){
+        if(name == NAMES[i]){
+            fullPolicy_ = i;
+            sampleRate_ = max(sampleRate, 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Log::Commit_(LogRing* ring, const char* data, size_t len, uint8_t kind, int level){
+    if(ring){
+        ring->Commit(len, kind, level);
+        if(level >= 3){
+            // ERROR 立即落盘：先提交再置标记，后台线程看到标记时一定能取到这一行
+            urgent_.store(true, memory_order_release);
+            cond_.notify_one();
+        }else if(ring->Pressured()){
+            cond_.notify_one();
+        }
+        return;
+    }
+    long usec;
+    const Clock& now = Now_(&usec);
+    lock_guard<mutex> locker(mtx_);
+    WriteLine_(data, len, kind, now);
+    // 同步模式没有后台线程按时间刷新，每行写入文件，安静期之前的日志不会留在缓冲里
+    MaybeFlush_(true);
+}
+
+uint32_t Log::RegisterFormat(const char* format){
+    lock_guard<mutex> locker(fmtMtx_);
+    formats_.push_back(format);
+    return formats_.size() - 1;
+}
+
+size_t Log::FormatArgs_(char* line, const Clock& now, long usec, int level, const char* format, ...){
+    va_list vaList;
+    va_start(vaList, format);
+    size_t len = Format_(line, now, usec, level, format, vaList);
+    va_end(vaList);
+    return len;
+}
+
+const Log::Clock& Log::Now_(long* usec){
+    static thread_local Clock clock = {-1, 0, 0, 0, {0}};
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    *usec = ts.tv_nsec / 1000;
+    if(ts.tv_sec != clock.sec){
+        struct tm t;
+        localtime_r(&ts.tv_sec, &t);
+        clock.sec = ts.tv_sec;
+        clock.year = t.tm_year + 1900;
+        clock.mon = t.tm_mon + 1;
+        clock.mday = t.tm_mday;
+        /* "YYYY-MM-DD HH:MM:SS"：与微秒一样直接渲染数字 */
+        auto put = [](char* p, int value, int width){
+            for(int i = width - 1; i >= 0; i--){
+                p[i] = '0' + value % 10;
+                value /= 10;
+            }
+        };
+        put(clock.prefix, clock.year, 4);
+        clock.prefix[4] = '-';
+        put(clock.prefix + 5, clock.mon, 2);
+        clock.prefix[7] = '-';
+        put(clock.prefix + 8, clock.mday, 2);
+        clock.prefix[10] = ' ';
+        put(clock.prefix + 11, t.tm_hour, 2);
+        clock.prefix[13] = ':';
+        put(clock.prefix + 14, t.tm_min, 2);
+        clock.prefix[16] = ':';
+        put(clock.prefix + 17, t.tm_sec, 2);
+        clock.prefix[19] = '\0';
+    }
+    return clock;
+}
+
+size_t Log::Format_(char* line, const Clock& now, long usec, int level, const char* format, va_list vaList){
+    const size_t cap = LogRing::LINE_SIZE - 1;  // 留一个字节给换行
+    /* "YYYY-MM-DD HH:MM:SS.uuuuuu "：前缀直接复制，只渲染微秒 */
+    memcpy(line, now.prefix, 19);
+    line[19] = '.';
+    for(int i = 25; i >= 20; i--){
+        line[i] = '0' + usec % 10;
+        usec /= 10;
+    }
+    line[26] = ' ';
+    size_t len = 27;
+    memcpy(line + len, logbin::LevelTitle(level), 9);
+    len += 9;
+    int m = vsnprintf(line + len, cap - len, format, vaList);
+    if(m > 0){
+        len += min<size_t>(m, cap - len - 1);    // 超长截断（vsnprintf 返回的是完整长度）
+    }
+    line[len++] = '\n';
+    return len;
+}
+
+void Log::WriteLine_(const char* line, size_t len, uint8_t kind, const Clock& now){
+    if(!fp_) { return; }
+    /* 日志日期 日志行数 */
+    if(toDay_ != now.mday || (lineCount_ && (lineCount_ % MAX_LINES == 0))){
         char newFile[LOG_NAME_LEN];
         char tail[36] = {0};
-        snprintf(tail,36,"%04d_%02d_%02d", t.tm_year + 1900,t.tm_mon + 1,t.tm_mday);
-        if(toDay_ != t.tm_mday){
-            snprintf(newFile, LOG_NAME_LEN - 72, "%s/%s%s", path_, tail, suffix_);
-            toDay_ = t.tm_mday;
+        snprintf(tail,36,"%04d_%02d_%02d", now.year, now.mon, now.mday);
+        if(toDay_ != now.mday){
+            snprintf(newFile, LOG_NAME_LEN - 72, "%s/%s%s%s", path_, tail, suffix_, binaryFile_ ? ".bin" : "");
+            toDay_ = now.mday;
             lineCount_ = 0;
         }
         else{
-            snprintf(newFile, LOG_NAME_LEN - 72, "%s/%s-%d%s", path_, tail, (lineCount_  / MAX_LINES), suffix_);
+            snprintf(newFile, LOG_NAME_LEN - 72, "%s/%s-%d%s%s", path_, tail, (lineCount_  / MAX_LINES), suffix_,
+                     binaryFile_ ? ".bin" : "");
         }
-        locker.lock();
-        flush();
+        fflush(fp_);
         fclose(fp_);
-        fp_ = fopen(newFile, "a");
+        fp_ = OpenFile_(newFile);
         assert(fp_ != nullptr);
     }
+    lineCount_++;
+    if(!binaryFile_){
+        if(kind == logbin::TEXT) { fwrite(line, 1, len, fp_); }
+        // 切换回文本模式前留下的二进制记录无法在这里还原，丢弃
+        return;
+    }
+    if(kind == logbin::RECORD){
+        uint32_t id;
+        memcpy(&id, line + 4, 4);
+        WriteFormats_(id);
+        fwrite(line, 1, len, fp_);
+    }else{
+        char head[4] = {(char)logbin::TEXT, 0, 0, 0};
+        uint16_t len16 = len;
+        memcpy(head + 2, &len16, 2);
+        fwrite(head, 1, 4, fp_);
+        fwrite(line, 1, len, fp_);
+    }
+}
 
-    {
-        unique_lock<mutex> locker(mtx_);
-        lineCount_++;
-        int n = snprintf(buff_.BeginWrite(),128,"%d-%02d-%02d %02d:%02d:%02d.%06ld ",
-                    t.tm_year + 1900, t.tm_mon + 1, t.tm_mday,
-                    t.tm_hour, t.tm_min, t.tm_sec, now.tv_usec);
-        buff_.HasWritten(n);
-        AppendLogLevelTitle_(level);
-
-        va_start(vaList,format);
-        int m = vsnprintf(buff_.BeginWrite(),buff_.WritableBytes(),format,vaList);
-        va_end(vaList);
-
-        buff_.HasWritten(m);
-        buff_.Append("\n\0", 2);
-
-        if(isAsync_ && deque_ && !deque_->full()){
-            deque_->push_back(buff_.RetrieveAllToStr());
-        }else{
-            fputs(buff_.Peek(),fp_);
+void Log::WriteFormats_(uint32_t id){
+    if(id < formatsWritten_) { return; }
+    lock_guard<mutex> locker(fmtMtx_);
+    for(; formatsWritten_ < formats_.size(); formatsWritten_++){
+        const char* format = formats_[formatsWritten_];
+        char head[7] = {(char)logbin::FORMAT};
+        uint32_t fid = formatsWritten_;
+        uint16_t len = min<size_t>(strlen(format), UINT16_MAX);
+        memcpy(head + 1, &fid, 4);
+        memcpy(head + 5, &len, 2);
+        fwrite(head, 1, 7, fp_);
+        fwrite(format, 1, len, fp_);
+    }
+}
+
+FILE* Log::OpenFile_(const char* fileName){
+    FILE* fp = fopen(fileName, "a");
+    if(fp){
+        // 全缓冲：攒满 flushBytes_ 才调用一次 write，其余由 MaybeFlush_ 按时间刷新
+        setvbuf(fp, nullptr, _IOFBF, flushBytes_);
+        if(binaryFile_){
+            // 格式编号只在本次打开内有效：写入 MAGIC，之后用到的格式串重新写出
+            fwrite(logbin::MAGIC, 1, logbin::MAGIC_LEN, fp);
+            formatsWritten_ = 0;
         }
-        buff_.RetrieveAll();
     }
+    return fp;
+}
 
+int64_t Log::NowMs_(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
 }
 
-void Log::AppendLogLevelTitle_(int level) {
-    switch(level) {
-    case 0:
-        buff_.Append("[debug]: ", 9);
-        break;
-    case 1:
-        buff_.Append("[info] : ", 9);
-        break;
-    case 2:
-        buff_.Append("[warn] : ", 9);
-        break;
-    case 3:
-        buff_.Append("[error]: ", 9);
-        break;
-    default:
-        buff_.Append("[info] : ", 9);
-        break;
+void Log::MaybeFlush_(bool urgent){
+    if(!fp_) { return; }
+    int64_t now = NowMs_();
+    if(urgent || now - lastFlushMs_ >= flushMs_){
+        fflush(fp_);
+        lastFlushMs_ = now;
+    }
+}
+
+void Log::SetFlushPolicy(int intervalMs, size_t bytes){
+    lock_guard<mutex> locker(mtx_);
+    flushMs_ = max(intervalMs, 1);
+    flushBytes_ = max<size_t>(bytes, 4096);
+}
+
+LogRing* Log::LocalRing_(){
+    if(!t_ring.ring){
+        t_ring.ring = new LogRing(ringSlots_);
+        lock_guard<mutex> locker(ringMtx_);
+        rings_.push_back(t_ring.ring);
+    }
+    return t_ring.ring;
+}
+
+size_t Log::DrainRings_(){
+    // 一批日志共用后台线程的时间缓存判断是否跨天
+    long usec;
+    const Clock& now = Now_(&usec);
+    size_t lines = 0;
+    bool urgent = urgent_.exchange(false, memory_order_acq_rel);  // 先取标记再取日志，见 write
+    lock_guard<mutex> ringLocker(ringMtx_);
+    lock_guard<mutex> locker(mtx_);
+    for(auto it = rings_.begin(); it != rings_.end();){
+        LogRing* ring = *it;
+        bool closed = ring->Closed();   // 先读关闭标记：关闭之前提交的行这一轮一定能取到
+        auto write = [&](const char* line, size_t len, uint8_t kind){ WriteLine_(line, len, kind, now); };
+        lines += fullPolicy_ == DROP_OLDEST ? ring->DrainShared(write) : ring->Drain(write);
+        ReportDrops_(ring, now, usec);
+        if(closed){
+            delete ring;
+            it = rings_.erase(it);
+        }else{
+            ++it;
+        }
+    }
+    ReportDrops_(nullptr, now, usec);
+    MaybeFlush_(urgent);
+    return lines;
+}
+
+void Log::ReportDrops_(LogRing* ring, const Clock& now, long usec){
+    if(ring){
+        for(int i = 0; i < LogRing::LEVEL_COUNT; i++){
+            pendingDrops_[i] += ring->TakeDrops(i);
+        }
+        return;
+    }
+    uint64_t total = 0;
+    for(int i = 0; i < LogRing::LEVEL_COUNT; i++){
+        total += pendingDrops_[i];
+    }
+    int64_t nowMs = NowMs_();
+    if(total == 0 || nowMs - lastDropReportMs_ < DROP_REPORT_MS) { return; }
+    lastDropReportMs_ = nowMs;
+    char line[LogRing::LINE_SIZE];
+    size_t len = FormatArgs_(line, now, usec, 2, "Log ring full: %lu lines dropped (debug %lu, info %lu, warn %lu, error %lu)",
+                             (unsigned long)total, (unsigned long)pendingDrops_[0], (unsigned long)pendingDrops_[1],
+                             (unsigned long)pendingDrops_[2], (unsigned long)pendingDrops_[3]);
+    WriteLine_(line, len, logbin::TEXT, now);
+    for(int i = 0; i < LogRing::LEVEL_COUNT; i++){
+        pendingDrops_[i] = 0;
     }
 }
 
 void Log::flush() {
-    if(isAsync_) { 
-        deque_->flush(); 
+    if(isAsync_.load(memory_order_acquire)) {
+        urgent_.store(true, memory_order_release);
+        cond_.notify_one();     // 后台线程写完这一批后 fflush
+        return;
     }
-    fflush(fp_);
+    lock_guard<mutex> locker(mtx_);
+    if(fp_) { fflush(fp_); }
 }
 
 void Log::AsyncWrite_() {
-    string str = "";
-    while(deque_->pop(str)) {
-        //lock_guard<mutex> locker(mtx_);
-        fputs(str.c_str(), fp_);
+    while(true) {
+        bool stop = stop_.load(memory_order_acquire);
+        if(DrainRings_() > 0) { continue; }
+        if(stop) { break; }
+        unique_lock<mutex> locker(condMtx_);
+        if(!urgent_.load(memory_order_acquire)){
+            cond_.wait_for(locker, chrono::milliseconds(min(IDLE_WAIT_MS, flushMs_)));
+        }
     }
 }
+
 Log* Log::Instance() {
     static Log inst;
     return &inst;
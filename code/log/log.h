@@ -4,46 +4,128 @@
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
+#include <atomic>
+#include <condition_variable>
 #include <sys/time.h>
 #include <string.h>
 #include <stdarg.h>           // vastart va_end // 处理可变参数（日志格式化）
 #include <assert.h>
 #include <sys/stat.h>         //mkdir
-#include "blockqueue.h"
-#include "../buffer/buffer.h"
+#include "logring.h"
+#include "logbinary.h"
 
+// 编译期最低日志级别（构建时 -DLOG_MIN_LEVEL=N）：低于它的 LOG_* 调用不生成代码，参数也不求值
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
+
+// 异步模式下每个写日志的线程把日志行格式化进自己的 LogRing（无锁），
+// 后台线程批量取走各线程的环并写入文件；文件只由后台线程（或同步模式下持 mtx_ 的线程）写。
+// 二进制模式下不在调用线程上格式化，只记录格式编号和原始参数（见 logbin），用 logdecode 还原成文本。
 class Log{
 public:
-    // 初始化日志：级别、路径、后缀、异步队列容量
-    void init(int level, const char* path = "./log",const char* suffix = ".log", int maxQueueCapacity = 1024);
+    // 日志模块：按调用处源文件所在目录区分（见 LogModuleOf），每个模块有自己的运行期级别
+    enum MODULE {
+        CORE = 0,   // 其他（main、log、buffer）
+        HTTP,
+        SERVER,
+        TIMER,
+        POOL,
+        MODULE_COUNT,
+    };
+
+    // 异步模式下线程的环形缓冲满时的处理（见 SetFullPolicy）
+    enum FULL_POLICY {
+        BLOCK = 0,      // 等待后台线程腾出空间（不丢日志，日志突发时会拖慢请求线程）
+        DROP_NEWEST,    // 丢弃这一行
+        DROP_OLDEST,    // 挤掉环里最旧的一行
+        SAMPLE,         // 环内超过一半时只保留每 sampleRate 行中的一行（ERROR 除外），满时丢弃
+    };
+
+    // 初始化日志：级别、路径、后缀、异步模式下每个线程环形缓冲的行数（<= 0 为同步模式）、
+    // 是否二进制模式（文件名后缀再加 .bin）
+    void init(int level, const char* path = "./log",const char* suffix = ".log", int maxQueueCapacity = 1024,
+              bool binary = false);
     // 单例模式：获取唯一日志实例
     static Log* Instance();
     // 异步日志的刷写线程入口
     static void FlushLogThread();
 
     // 写日志（支持可变参数格式化）
-    void write(int level, const char* format,...);
-    // 刷新缓冲区到文件
+    void write(int level, const char* format,...) __attribute__((format(printf, 3, 4)));
+    // 二进制模式写日志：fmtId 为 RegisterFormat 得到的编号，参数原样编码
+    template<class... Args>
+    void writeBinary(int level, uint32_t fmtId, const Args&... args);
+    // 登记格式串（须为字符串字面量），返回格式编号；由 LOG_BASE 在每个调用处只执行一次
+    uint32_t RegisterFormat(const char* format);
+    bool IsBinary() { return binary_.load(std::memory_order_relaxed); }
+    // 刷新缓冲区到文件（异步模式下交给后台线程）
     void flush();
-    // 获取/设置日志级别
-    int GetLevel();
+    // 刷新策略（异步模式）：缓冲满 bytes 字节或距上次刷新超过 intervalMs 毫秒时写入文件，ERROR 日志立即刷新。
+    // 在 init 之前调用。同步模式没有后台线程按时间刷新，仍然每行 fflush
+    void SetFlushPolicy(int intervalMs, size_t bytes);
+    // 环满策略："block"、"drop_newest"、"drop_oldest"、"sample"；名字无法识别时返回 false。
+    // 在 init 之前调用。丢弃的行按级别计数，后台线程每秒写一条汇总
+    bool SetFullPolicy(const std::string& name, int sampleRate = 10);
+    // 获取/设置日志级别（原子变量，不加锁）；SetLevel 同时设置所有模块
+    int GetLevel(int module = CORE) { return levels_[module].load(std::memory_order_relaxed); }
     void SetLevel(int level);
+    // 单独设置一个模块的级别，如线上只对 pool 打开 debug
+    void SetModuleLevel(int module, int level) { levels_[module].store(level, std::memory_order_relaxed); }
+    // 按 "http=0,pool=0" 形式设置若干模块的级别，有无法识别的项时返回 false（其余项仍生效）
+    bool SetModuleLevels(const std::string& spec);
+    static const char* ModuleName(int module);
     // 检查日志是否开启
-    bool IsOpen(){return isOpen_;}
+    bool IsOpen(){return isOpen_.load(std::memory_order_acquire);}
 
 private:
     // 私有构造/析构：禁止外部创建/销毁实例（单例）
     Log();
-    // 拼接日志级别前缀（如[DEBUG]、[INFO]）
-    void AppendLogLevelTitle_(int level);
     virtual ~Log();
     // 异步写日志的核心逻辑
     void AsyncWrite_();
+    // 每个线程缓存的当前时间：秒数变化时才调用 localtime_r 并重新渲染前缀，同一秒内只格式化微秒
+    struct Clock {
+        time_t sec;
+        int year, mon, mday;
+        char prefix[20];    // "YYYY-MM-DD HH:MM:SS"
+    };
+    // 当前线程的时间缓存（按需刷新），usec 返回当前微秒
+    static const Clock& Now_(long* usec);
+    // 时间戳 + 级别前缀 + 正文格式化进 line（容量 LogRing::LINE_SIZE），返回含换行的长度
+    static size_t Format_(char* line, const Clock& now, long usec, int level, const char* format, va_list vaList);
+    static size_t FormatArgs_(char* line, const Clock& now, long usec, int level, const char* format, ...)
+        __attribute__((format(printf, 5, 6)));
+    // 后台线程：汇总各环新增的丢弃数，每 DROP_REPORT_MS 写一条（持有 ringMtx_、mtx_）
+    void ReportDrops_(LogRing* ring, const Clock& now, long usec);
+    // 异步模式：按环满策略取本线程环的空槽，这一行被丢弃时返回 false；
+    // 同步模式 *slot 为 nullptr，由调用方使用栈上缓冲
+    bool Claim_(int level, LogRing** ring, char** slot);
+    // 提交一条记录（kind 为 logbin::TEXT/RECORD）：异步模式提交进环，同步模式持 mtx_ 直接写文件
+    void Commit_(LogRing* ring, const char* data, size_t len, uint8_t kind, int level);
+    // 写入一条记录（持有 mtx_），按日期和行数切换文件
+    void WriteLine_(const char* line, size_t len, uint8_t kind, const Clock& now);
+    // 二进制文件：在编号 id 的记录之前写入尚未写出的格式串（持有 mtx_）
+    void WriteFormats_(uint32_t id);
+    // 打开日志文件并设置 flushBytes_ 大小的全缓冲，二进制文件写入 MAGIC（持有 mtx_）
+    FILE* OpenFile_(const char* fileName);
+    // 按刷新策略决定是否 fflush（持有 mtx_）
+    void MaybeFlush_(bool urgent);
+    static int64_t NowMs_();
+    // 当前线程的环形缓冲，首次调用时创建并登记
+    LogRing* LocalRing_();
+    // 后台线程：取空所有线程的环写入文件，返回写入的行数
+    size_t DrainRings_();
 private:
     // 常量定义：路径长度、文件名长度、单文件最大行数
     static const int LOG_PATH_LEN = 256;
     static const int LOG_NAME_LEN = 256;
     static const int MAX_LINES = 50000;
+    // 后台线程没有日志可取时的等待间隔（毫秒）
+    static constexpr int IDLE_WAIT_MS = 10;
+    // 丢弃汇总的输出间隔（毫秒）
+    static constexpr int DROP_REPORT_MS = 1000;
 
     // 日志存储路径（如"./log"）
     const char* path_;
@@ -57,34 +139,113 @@ private:
     // 当前日期（防止跨天写入同一文件）
     int toDay_;
     // 日志是否开启
-    bool isOpen_;
-    // 自定义缓冲区（减少频繁IO）
-    Buffer buff_;
-    // 当前日志级别（低于该级别不输出）
-    int level_;
+    std::atomic<bool> isOpen_;
+    // 各模块当前日志级别（低于该级别不输出）
+    std::atomic<int> levels_[MODULE_COUNT];
     // 是否开启异步模式
-    bool isAsync_;
+    std::atomic<bool> isAsync_;
+    // 是否二进制模式；binaryFile_ 为当前打开的文件是否二进制（持有 mtx_）
+    std::atomic<bool> binary_;
+    bool binaryFile_;
 
     // 日志文件指针
     FILE* fp_;
-    // 阻塞队列：异步模式下暂存日志内容
-    std::unique_ptr<BlockDeque<std::string>> deque_;
+    // 刷新策略（见 SetFlushPolicy）和上次刷新时间
+    int flushMs_;
+    size_t flushBytes_;
+    int64_t lastFlushMs_;
     // 异步写日志的线程
     std::unique_ptr<std::thread> writeThread_;
+    // 保护 fp_、lineCount_、toDay_（文件写入和切换）
     std::mutex mtx_;
+
+    // 各线程的环形缓冲（线程退出后由后台线程取空并释放）
+    std::vector<LogRing*> rings_;
+    std::mutex ringMtx_;
+    // 新建环形缓冲的槽位数
+    size_t ringSlots_;
+    // 唤醒后台线程
+    std::mutex condMtx_;
+    std::condition_variable cond_;
+    std::atomic<bool> stop_;
+    // 有 ERROR 日志或显式 flush，后台线程取完这一批后立即刷新
+    std::atomic<bool> urgent_;
+    // 环满策略和抽样比例（init 之前设置）
+    int fullPolicy_;
+    size_t sampleRate_;
+    // 尚未汇总输出的各级别丢弃数和上次输出时间（后台线程使用）
+    uint64_t pendingDrops_[LogRing::LEVEL_COUNT];
+    int64_t lastDropReportMs_;
+
+    // 二进制模式的格式表（下标为编号），及当前文件已写出的格式数（持有 mtx_）
+    std::vector<const char*> formats_;
+    std::mutex fmtMtx_;
+    size_t formatsWritten_;
 };
+
+template<class... Args>
+void Log::writeBinary(int level, uint32_t fmtId, const Args&... args){
+    char local[LogRing::LINE_SIZE];
+    LogRing* ring;
+    char* rec;
+    if(!Claim_(level, &ring, &rec)) { return; }
+    if(!rec) { rec = local; }
+    logbin::RecordWriter writer(rec, LogRing::LINE_SIZE, level, fmtId);
+    (writer.Put(args), ...);
+    Commit_(ring, rec, writer.Finish(), logbin::RECORD, level);
+}
+
+// 取 file 的最后一级目录名对应的模块，编译期求值；头文件里的日志按头文件所在目录归类
+constexpr int LogModuleOf(const char* file) {
+    const char* names[] = {"http", "server", "timer", "pool"};
+    int last = -1, prev = -1;
+    for(int i = 0; file[i]; i++) {
+        if(file[i] == '/') { prev = last; last = i; }
+    }
+    if(prev < 0) { return Log::CORE; }
+    for(int m = 0; m < 4; m++) {
+        int i = 0;
+        while(names[m][i] && prev + 1 + i < last && file[prev + 1 + i] == names[m][i]) { i++; }
+        if(!names[m][i] && prev + 1 + i == last) { return Log::HTTP + m; }
+    }
+    return Log::CORE;
+}
+
+// 被编译期级别去掉的调用：保留格式串和参数的类型检查（参数不求值、不生成代码）
+inline void LogDiscard(const char*, ...) __attribute__((format(printf, 1, 2)));
+inline void LogDiscard(const char*, ...) {}
+
 #define LOG_BASE(level, format, ...)\
     do{\
+        constexpr int logModule = LogModuleOf(__FILE__);\
         Log* log = Log::Instance();\
-        if(log->IsOpen() && log->GetLevel() <= level){\
-            log->write(level,format,##__VA_ARGS__);\
-            log->flush();\
+        if((level) >= LOG_MIN_LEVEL && log->IsOpen() && log->GetLevel(logModule) <= (level)){\
+            if(log->IsBinary()){\
+                static const uint32_t logFmtId = log->RegisterFormat(format);\
+                log->writeBinary(level, logFmtId, ##__VA_ARGS__);\
+            }else{\
+                log->write(level,format,##__VA_ARGS__);\
+            }\
         }\
     }while(0);
 
+#define LOG_DISCARD(format, ...) do{ if(false){ LogDiscard(format, ##__VA_ARGS__); } }while(0);
+
+#if LOG_MIN_LEVEL <= 0
 #define LOG_DEBUG(format,...)do{LOG_BASE(0,format,##__VA_ARGS__)} while(0);
+#else
+#define LOG_DEBUG(format,...)LOG_DISCARD(format,##__VA_ARGS__)
+#endif
+#if LOG_MIN_LEVEL <= 1
 #define LOG_INFO(format,...) do {LOG_BASE(1, format,##__VA_ARGS__)} while(0);
+#else
+#define LOG_INFO(format,...) LOG_DISCARD(format,##__VA_ARGS__)
+#endif
+#if LOG_MIN_LEVEL <= 2
 #define LOG_WARN(format,...) do {LOG_BASE(2,format,##__VA_ARGS__)} while(0);
+#else
+#define LOG_WARN(format,...) LOG_DISCARD(format,##__VA_ARGS__)
+#endif
 #define LOG_ERROR(format, ...) do {LOG_BASE(3, format, ##__VA_ARGS__)} while(0);
 
 #endif //LOG_H
\ No newline at end of file
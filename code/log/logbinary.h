@@ -0,0 +1,115 @@
+#ifndef LOGBINARY_H
+#define LOGBINARY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <type_traits>
+
+// 二进制日志（Log::init 的 binary）的文件格式，日志库和离线解码工具 logdecode 共用。
+// 调用处的格式串在第一次执行时登记一次，得到格式编号；之后每条日志只复制编号、时间戳和原始参数，
+// 不在写日志的线程上做 vsnprintf/localtime，由 logdecode 事后按格式串还原成文本。
+//
+// 文件由连续的记录组成，记录的第一个字节为类型：
+//   MAGIC   "WSBLOG1\n"，每次打开文件时写入；格式编号只在一次打开内有效，解码时遇到它清空格式表
+//   FORMAT  [type][u32 id][u16 len][格式串]，在第一次用到该编号的记录之前写入
+//   RECORD  [type][u8 level][u16 argLen][u32 id][u64 时间戳 ns][参数 argLen 字节]
+//   TEXT    [type][u8 level][u16 len][文本行]（切换到二进制模式前留在缓冲里的文本日志）
+// 参数为 [u8 tag][值]：整数、浮点、指针按 8 字节原值，字符串为 [u16 len][内容]。
+// 多字节整数按本机字节序，解码需在同类机器上进行。
+namespace logbin {
+
+const char MAGIC[] = "WSBLOG1\n";
+const size_t MAGIC_LEN = 8;
+
+enum TYPE : uint8_t {
+    FORMAT = 1,
+    RECORD = 2,
+    TEXT = 3,
+    MAGIC_TYPE = 'W',
+};
+
+enum TAG : uint8_t {
+    INT = 'i',
+    UINT = 'u',
+    DOUBLE = 'f',
+    STR = 's',
+    PTR = 'p',
+};
+
+const size_t RECORD_HEADER = 16;
+
+// 日志级别前缀，文本日志和解码工具共用
+inline const char* LevelTitle(int level) {
+    static const char* TITLES[] = {"[debug]: ", "[info] : ", "[warn] : ", "[error]: "};
+    return (level >= 0 && level <= 3) ? TITLES[level] : TITLES[1];
+}
+
+// 把一条日志编码进 buf（容量 cap）：构造时写入记录头和时间戳，逐个 Put 参数，Finish 返回记录长度。
+// 放不下的参数整体丢弃（字符串截断），解码时显示为 <?>
+class RecordWriter {
+public:
+    RecordWriter(char* buf, size_t cap, int level, uint32_t id): buf_(buf), p_(buf + RECORD_HEADER), end_(buf + cap) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        uint64_t ns = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+        buf_[0] = RECORD;
+        buf_[1] = (char)level;
+        memcpy(buf_ + 4, &id, 4);
+        memcpy(buf_ + 8, &ns, 8);
+    }
+
+    template<class T>
+    void Put(const T& value) {
+        using D = std::decay_t<T>;
+        if constexpr(std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+            PutStr_(value);
+        } else if constexpr(std::is_floating_point_v<D>) {
+            PutRaw_(DOUBLE, (double)value);
+        } else if constexpr(std::is_enum_v<D>) {
+            PutRaw_(INT, (int64_t)value);
+        } else if constexpr(std::is_integral_v<D> && std::is_signed_v<D>) {
+            PutRaw_(INT, (int64_t)value);
+        } else if constexpr(std::is_integral_v<D>) {
+            PutRaw_(UINT, (uint64_t)value);
+        } else {
+            static_assert(std::is_pointer_v<D>, "unsupported binary log argument");
+            PutRaw_(PTR, (uint64_t)(uintptr_t)value);
+        }
+    }
+
+    size_t Finish() {
+        uint16_t argLen = p_ - buf_ - RECORD_HEADER;
+        memcpy(buf_ + 2, &argLen, 2);
+        return p_ - buf_;
+    }
+
+private:
+    template<class V>
+    void PutRaw_(uint8_t tag, V value) {
+        if((size_t)(end_ - p_) < 1 + sizeof(V)) { end_ = p_; return; }  // 放不下，后面的参数也不再写入
+        *p_++ = tag;
+        memcpy(p_, &value, sizeof(V));
+        p_ += sizeof(V);
+    }
+
+    void PutStr_(const char* s) {
+        if((size_t)(end_ - p_) < 3) { end_ = p_; return; }
+        size_t len = s ? strlen(s) : 0;
+        len = len < (size_t)(end_ - p_ - 3) ? len : end_ - p_ - 3;
+        uint16_t len16 = len;
+        *p_++ = STR;
+        memcpy(p_, &len16, 2);
+        if(len) { memcpy(p_ + 2, s, len); }
+        p_ += 2 + len;
+    }
+
+    char* buf_;
+    char* p_;
+    char* end_;
+};
+
+} // namespace logbin
+
+#endif //LOGBINARY_H
@@ -0,0 +1,124 @@
+#ifndef LOGRENDER_H
+#define LOGRENDER_H
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+#include "logbinary.h"
+
+// 把二进制日志记录的参数按格式串还原成文本，供 logdecode 使用（RecordWriter 的逆过程）
+namespace logbin {
+
+struct Arg {
+    uint8_t tag;
+    uint64_t bits;      // INT/UINT/PTR/DOUBLE 的原始 8 字节
+    std::string str;         // STR
+};
+
+// 解析记录中的参数，遇到不完整的数据停止
+inline std::vector<Arg> ParseArgs(const char* p, size_t len) {
+    std::vector<Arg> args;
+    const char* end = p + len;
+    while(p < end) {
+        Arg arg;
+        arg.tag = *p++;
+        if(arg.tag == STR) {
+            uint16_t n;
+            if(end - p < 2) { break; }
+            memcpy(&n, p, 2);
+            p += 2;
+            if(end - p < n) { break; }
+            arg.str.assign(p, n);
+            p += n;
+        } else {
+            if(end - p < 8) { break; }
+            memcpy(&arg.bits, p, 8);
+            p += 8;
+        }
+        args.push_back(std::move(arg));
+    }
+    return args;
+}
+
+// 整数按格式里的长度修饰截断，与 printf 对原类型的解释一致
+inline long long AsSigned(const Arg& arg, const std::string& length) {
+    long long v = (long long)arg.bits;
+    if(length == "hh") { return (signed char)v; }
+    if(length == "h") { return (short)v; }
+    if(length.empty()) { return (int)v; }
+    return v;
+}
+
+inline unsigned long long AsUnsigned(const Arg& arg, const std::string& length) {
+    unsigned long long v = arg.bits;
+    if(length == "hh") { return (unsigned char)v; }
+    if(length == "h") { return (unsigned short)v; }
+    if(length.empty()) { return (unsigned int)v; }
+    return v;
+}
+
+// 按格式串逐个转换说明渲染参数；参数缺失（记录被截断）显示为 <?>
+inline std::string Render(const std::string& format, const std::vector<Arg>& args) {
+    std::string out;
+    size_t next = 0;
+    char buf[512];
+    for(size_t i = 0; i < format.size(); i++) {
+        if(format[i] != '%') { out += format[i]; continue; }
+        if(i + 1 < format.size() && format[i + 1] == '%') { out += '%'; i++; continue; }
+        /* 取出一个完整的转换说明：标志、宽度、精度、长度修饰、转换字符 */
+        std::string spec = "%";
+        size_t j = i + 1;
+        while(j < format.size() && strchr("-+ #0", format[j])) { spec += format[j++]; }
+        while(j < format.size() && (isdigit((unsigned char)format[j]) || format[j] == '.' || format[j] == '*')) {
+            if(format[j] == '*') {
+                // 宽度/精度参数
+                spec += next < args.size() ? std::to_string((int)args[next].bits) : "0";
+                next++;
+                j++;
+            } else {
+                spec += format[j++];
+            }
+        }
+        std::string length;
+        while(j < format.size() && strchr("hlLqjzt", format[j])) { length += format[j++]; }
+        if(j >= format.size()) { out += spec + length; break; }
+        char conv = format[j];
+        i = j;
+        if(next >= args.size()) { out += "<?>"; next++; continue; }
+        const Arg& arg = args[next++];
+        switch(conv) {
+        case 'd': case 'i':
+            snprintf(buf, sizeof(buf), (spec + "ll" + conv).c_str(), AsSigned(arg, length));
+            break;
+        case 'u': case 'o': case 'x': case 'X':
+            snprintf(buf, sizeof(buf), (spec + "ll" + conv).c_str(), AsUnsigned(arg, length));
+            break;
+        case 'c':
+            snprintf(buf, sizeof(buf), (spec + conv).c_str(), (int)arg.bits);
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+            double d;
+            memcpy(&d, &arg.bits, 8);
+            snprintf(buf, sizeof(buf), (spec + conv).c_str(), d);
+            break;
+        }
+        case 's':
+            snprintf(buf, sizeof(buf), (spec + conv).c_str(), arg.tag == STR ? arg.str.c_str() : "<?>");
+            break;
+        case 'p':
+            snprintf(buf, sizeof(buf), (spec + conv).c_str(), (void*)(uintptr_t)arg.bits);
+            break;
+        default:
+            snprintf(buf, sizeof(buf), "<%%%c?>", conv);
+            break;
+        }
+        out += buf;
+    }
+    return out;
+}
+
+} // namespace logbin
+
+#endif //LOGRENDER_H
@@ -0,0 +1,188 @@
+#ifndef LOGRING_H
+#define LOGRING_H
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+// 单生产者单消费者的日志环形缓冲：每个写日志的线程独占一个，由日志后台线程批量取走。
+// 槽位定长，日志行直接格式化进槽位，写入路径只有两次原子读写，不加锁、不分配内存。
+// 环满时的处理由 Log 的溢出策略决定：等待、丢弃新行（Claim 返回 nullptr）或挤掉最旧的行（ClaimOverwrite）。
+class LogRing {
+public:
+    static const size_t LINE_SIZE = 512;    // 单行上限（含换行），超出部分截断
+    static const int LEVEL_COUNT = 4;       // 按级别统计丢弃行数（debug/info/warn/error）
+
+    // slots 为槽位数，取不小于它的 2 的幂
+    explicit LogRing(size_t slots);
+
+    // 生产者：取下一个空槽，环满时返回 nullptr；写完后 Commit 提交这一行的长度、种类（文本/二进制记录）和级别
+    char* Claim();
+    void Commit(size_t len, uint8_t kind = 0, int level = 0);
+    // 生产者：环满时挤掉最旧的一行腾出槽位，droppedLevel 返回被挤掉那一行的级别（没有挤掉时为 -1）。
+    // 要复用的槽位正被消费者读取时返回 nullptr，这一行由调用者丢弃。使用它时消费者必须用 DrainShared 取日志
+    char* ClaimOverwrite(int* droppedLevel);
+
+    // 消费者：按顺序把已提交的行交给 fn(data, len, kind)，返回取走的行数
+    template<class F>
+    size_t Drain(F&& fn);
+    // 消费者：生产者可能用 ClaimOverwrite 同时推进 tail_ 时使用，逐行先用 CAS 取得再读取，
+    // 读取期间通过 reading_ 告知生产者不要复用这个槽位
+    template<class F>
+    size_t DrainShared(F&& fn);
+
+    // 生产者：环内已用超过一半时返回 true（每提交 1/8 环才真正读一次 tail_，其余时候直接返回 false），
+    // 用于在环满之前唤醒后台线程
+    bool Pressured();
+    // 生产者：环内已用是否超过一半（每次都判断，用于抽样策略）
+    bool OverHalf();
+    // 生产者：抽样计数，每 rate 次返回一次 true
+    bool Sample(size_t rate) { return ++sampleSeq_ % rate == 0; }
+
+    // 生产者：记一行被丢弃；消费者：取该级别自上次调用以来新增的丢弃数
+    void CountDrop(int level);
+    uint64_t TakeDrops(int level);
+
+    // 所属线程退出时调用，后台线程取空后释放
+    void Close() { closed_.store(true, std::memory_order_release); }
+    bool Closed() const { return closed_.load(std::memory_order_acquire); }
+    bool Empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Slot {
+        uint16_t len;
+        uint8_t kind;
+        uint8_t level;
+        char data[LINE_SIZE];
+    };
+
+    static const size_t NOT_READING = SIZE_MAX;
+
+    static int LevelIndex_(int level) { return level < 0 ? 0 : (level >= LEVEL_COUNT ? LEVEL_COUNT - 1 : level); }
+
+    size_t mask_;
+    size_t checkMask_;      // Pressured 的检查间隔 - 1
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<bool> closed_;
+    uint64_t dropsSeen_[LEVEL_COUNT];       // 消费者已取走的丢弃数
+
+    alignas(64) std::atomic<size_t> head_;  // 下一个写入位置，只由生产者修改
+    size_t tailCache_;                      // 生产者看到的 tail_，只在看似已满或检查压力时重新读取
+    size_t sampleSeq_;
+    std::atomic<uint64_t> drops_[LEVEL_COUNT];  // 只由生产者递增
+    alignas(64) std::atomic<size_t> tail_;  // 下一个读取位置，由消费者修改（覆盖模式下生产者也会 CAS 推进）
+    std::atomic<size_t> reading_;           // DrainShared 正在读取的位置，没有时为 NOT_READING
+};
+
+inline LogRing::LogRing(size_t slots): closed_(false), head_(0), tailCache_(0), sampleSeq_(0), tail_(0),
+                                        reading_(NOT_READING) {
+    size_t n = 2;
+    while(n < slots) { n <<= 1; }
+    mask_ = n - 1;
+    checkMask_ = (n >= 8 ? n / 8 : 1) - 1;
+    slots_.reset(new Slot[n]);
+    for(int i = 0; i < LEVEL_COUNT; i++) {
+        dropsSeen_[i] = 0;
+        drops_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+inline char* LogRing::Claim() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if(head - tailCache_ > mask_) {
+        tailCache_ = tail_.load(std::memory_order_acquire);
+        if(head - tailCache_ > mask_) { return nullptr; }
+    }
+    return slots_[head & mask_].data;
+}
+
+inline char* LogRing::ClaimOverwrite(int* droppedLevel) {
+    *droppedLevel = -1;
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t tail = tail_.load(std::memory_order_seq_cst);
+    while(head - tail > mask_) {
+        // 与 DrainShared 争同一行：谁的 CAS 成功这一行归谁，消费者只读取自己 CAS 取得的行
+        if(tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_seq_cst, std::memory_order_seq_cst)) {
+            *droppedLevel = slots_[tail & mask_].level;    // 槽位只由本线程写，读取是安全的
+            tail++;
+        }
+    }
+    tailCache_ = tail;
+    // 要复用的槽位上一轮的那一行已被消费者取得，但可能还没读完：此时放弃本行，不覆盖它。
+    // 消费者先写 reading_ 再 CAS tail_，这里先看到 tail_ 越过它再读 reading_（均为 seq_cst），不会漏看
+    if(head > mask_ && reading_.load(std::memory_order_seq_cst) == head - mask_ - 1) { return nullptr; }
+    return slots_[head & mask_].data;
+}
+
+inline void LogRing::Commit(size_t len, uint8_t kind, int level) {
+    assert(len <= LINE_SIZE);
+    size_t head = head_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[head & mask_];
+    slot.len = len;
+    slot.kind = kind;
+    slot.level = LevelIndex_(level);
+    head_.store(head + 1, std::memory_order_release);
+}
+
+inline bool LogRing::Pressured() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if(head & checkMask_) { return false; }
+    tailCache_ = tail_.load(std::memory_order_acquire);
+    return head - tailCache_ > (mask_ + 1) / 2;
+}
+
+inline bool LogRing::OverHalf() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if(head - tailCache_ <= (mask_ + 1) / 2) { return false; }  // tailCache_ 只会偏旧，按它算未过半就一定未过半
+    tailCache_ = tail_.load(std::memory_order_acquire);
+    return head - tailCache_ > (mask_ + 1) / 2;
+}
+
+inline void LogRing::CountDrop(int level) {
+    std::atomic<uint64_t>& drops = drops_[LevelIndex_(level)];
+    drops.store(drops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+inline uint64_t LogRing::TakeDrops(int level) {
+    uint64_t total = drops_[level].load(std::memory_order_relaxed);
+    uint64_t delta = total - dropsSeen_[level];
+    dropsSeen_[level] = total;
+    return delta;
+}
+
+template<class F>
+size_t LogRing::Drain(F&& fn) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+    for(size_t i = tail; i != head; i++) {
+        const Slot& slot = slots_[i & mask_];
+        fn(slot.data, slot.len, slot.kind);
+    }
+    tail_.store(head, std::memory_order_release);
+    return head - tail;
+}
+
+template<class F>
+size_t LogRing::DrainShared(F&& fn) {
+    size_t count = 0;
+    size_t tail = tail_.load(std::memory_order_acquire);
+    while(tail != head_.load(std::memory_order_acquire)) {
+        // 先声明要读的位置，再 CAS 取得这一行；失败说明已被生产者挤掉（tail 更新为新值），换下一行
+        reading_.store(tail, std::memory_order_seq_cst);
+        if(tail_.compare_exchange_strong(tail, tail + 1, std::memory_order_seq_cst, std::memory_order_seq_cst)) {
+            const Slot& slot = slots_[tail & mask_];
+            fn(slot.data, slot.len, slot.kind);
+            count++;
+            tail++;
+        }
+        reading_.store(NOT_READING, std::memory_order_release);
+    }
+    return count;
+}
+
+#endif //LOGRING_H
@@ -5,9 +5,13 @@ int main(){
     /* 守护进程 后台运行 */
     //daemon(1, 0); 
 
+    ServerOptions options;
+    options.bundle = false; /* 资源包模式：静态资源打包成单个文件整体 mmap */
+
     WebServer server(
         1316,3,60000, false,/* 端口 ET模式 timeoutMs 优雅退出  */
         3306, "web", "123456", "webserver",/* Mysql配置 */
-        12,6,true,1,1024);/* 连接池数量 线程池数量 日志开关 日志等级 日志异步队列容量 */
+        12,6,true,1,1024,/* 连接池数量 线程池数量 日志开关 日志等级 日志异步队列容量 */
+        options);/* 可选特性 */
     server.Start();
 }
\ No newline at end of file
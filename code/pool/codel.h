@@ -0,0 +1,80 @@
+#ifndef CODEL_H
+#define CODEL_H
+
+#include <atomic>
+#include <chrono>
+#include <math.h>
+#include <stdint.h>
+
+// CoDel（Controlled Delay，Nichols & Jacobson）按排队时间做自适应丢弃：
+//   - 只看任务出队时的排队时间（sojourn），不看队列长度
+//   - 排队时间连续 interval 都高于 target 才进入丢弃状态；短暂的突发不会触发
+//   - 丢弃状态下第 n 次丢弃后间隔 interval / sqrt(n) 再丢下一个，直到排队时间回落到 target 以下
+// 多个工作线程并发调用 ShouldDrop，状态全部用原子变量维护，不加锁；
+// 并发下的丢弃节奏是近似的，这对过载保护足够。
+class CoDel {
+public:
+    explicit CoDel(int64_t targetUs = 5000, int64_t intervalUs = 100000)
+        : targetUs_(targetUs), intervalUs_(intervalUs),
+          firstAboveUs_(0), dropNextUs_(0), count_(0), dropping_(false), drops_(0) {}
+
+    CoDel(const CoDel&) = delete;
+    CoDel& operator=(const CoDel&) = delete;
+
+    // 任务出队（开始执行）时调用；返回 true 表示该任务应被丢弃（快速拒绝）
+    bool ShouldDrop(int64_t sojournUs, int64_t nowUs) {
+        if(sojournUs < targetUs_) {
+            /* 排队时间已回落：离开丢弃状态 */
+            firstAboveUs_.store(0, std::memory_order_relaxed);
+            dropping_.store(false, std::memory_order_relaxed);
+            return false;
+        }
+        int64_t first = firstAboveUs_.load(std::memory_order_relaxed);
+        if(first == 0) {
+            /* 刚超过 target：再观察一个 interval */
+            firstAboveUs_.compare_exchange_strong(first, nowUs + intervalUs_, std::memory_order_relaxed);
+            return false;
+        }
+        if(nowUs < first) { return false; }
+
+        if(!dropping_.load(std::memory_order_relaxed)) {
+            if(!dropping_.exchange(true)) {
+                /* 进入丢弃状态：如果刚离开不久，从上次的丢弃频率附近继续（CoDel 的 count 记忆） */
+                uint32_t count = count_.load(std::memory_order_relaxed);
+                bool recent = nowUs - dropNextUs_.load(std::memory_order_relaxed) < 16 * intervalUs_;
+                count_.store(recent && count > 2 ? count - 2 : 0, std::memory_order_relaxed);
+                dropNextUs_.store(nowUs, std::memory_order_relaxed);
+            }
+        }
+        int64_t next = dropNextUs_.load(std::memory_order_relaxed);
+        if(nowUs < next) { return false; }
+        uint32_t count = count_.fetch_add(1, std::memory_order_relaxed) + 1;
+        int64_t gap = static_cast<int64_t>(intervalUs_ / sqrt(static_cast<double>(count)));
+        if(!dropNextUs_.compare_exchange_strong(next, nowUs + gap, std::memory_order_relaxed)) {
+            return false;   // 同一时刻其他线程已经丢弃了一个
+        }
+        drops_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool Dropping() const { return dropping_.load(std::memory_order_relaxed); }
+
+    // 读取并清零丢弃计数（用于周期性输出）
+    uint64_t TakeDrops() { return drops_.exchange(0, std::memory_order_relaxed); }
+
+    static int64_t NowUs() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    const int64_t targetUs_;
+    const int64_t intervalUs_;
+    std::atomic<int64_t> firstAboveUs_;     // 排队时间持续超标到该时刻后开始丢弃（0 表示未超标）
+    std::atomic<int64_t> dropNextUs_;       // 下一次允许丢弃的时刻
+    std::atomic<uint32_t> count_;           // 本轮丢弃状态中的丢弃次数（控制丢弃频率）
+    std::atomic<bool> dropping_;
+    std::atomic<uint64_t> drops_;
+};
+
+#endif //CODEL_H
@@ -0,0 +1,139 @@
+#include "groupcommit.h"
+#include <unordered_set>
+using namespace std;
+
+GroupCommit::GroupCommit(): maxBatch_(1), window_(0), executor_(ExecuteSql_), flushing_(0), batches_(0), rows_(0) {}
+
+GroupCommit* GroupCommit::Instance() {
+    static GroupCommit commit;
+    return &commit;
+}
+
+void GroupCommit::Init(size_t maxBatch, int windowUs, Executor executor) {
+    maxBatch_ = maxBatch;
+    window_ = chrono::microseconds(windowUs > 0 ? windowUs : 0);
+    executor_ = executor ? std::move(executor) : Executor(ExecuteSql_);
+}
+
+bool GroupCommit::Insert(const string& name, const string& pwd) {
+    if(!Enabled()) {
+        Batch single;
+        single.items.push_back({name, pwd});
+        Execute_(&single);
+        return single.results[0];
+    }
+
+    unique_lock<mutex> locker(mtx_);
+    bool leader = false;
+    if(!open_) {
+        open_ = make_shared<Batch>();
+        open_->deadline = chrono::steady_clock::now() + window_;
+        leader = true;
+    }
+    shared_ptr<Batch> batch = open_;
+    size_t index = batch->items.size();
+    batch->items.push_back({name, pwd});
+    auto full = [&] { return batch->items.size() >= maxBatch_; };
+    if(full()) {
+        /* 凑满：后来者开新批，唤醒 leader 立即提交 */
+        open_.reset();
+        cond_.notify_all();
+    }
+
+    if(!leader) {
+        cond_.wait(locker, [&] { return batch->done; });
+        return batch->results[index];
+    }
+
+    /* leader：没有批次在提交时立即执行，单独的注册不付窗口的等待；
+       否则等够窗口或凑满，再等上一批提交完（凑满的批不等，用另一个连接并行提交） */
+    if(flushing_ > 0) {
+        cond_.wait_until(locker, batch->deadline, full);
+        cond_.wait(locker, [&] { return flushing_ == 0 || full(); });
+    }
+    if(open_ == batch) { open_.reset(); }
+    flushing_++;
+    locker.unlock();
+
+    Execute_(batch.get());
+
+    locker.lock();
+    flushing_--;
+    batch->done = true;
+    cond_.notify_all();
+    return batch->results[index];
+}
+
+void GroupCommit::Execute_(Batch* batch) {
+    size_t n = batch->items.size();
+    batch->results.assign(n, 0);
+    batches_.fetch_add(1, memory_order_relaxed);
+    rows_.fetch_add(n, memory_order_relaxed);
+    executor_(batch->items, &batch->results);
+}
+
+void GroupCommit::ExecuteSql_(const vector<Item>& items, vector<char>* results) {
+    size_t n = items.size();
+    MYSQL* sql;
+    SqlConnRAII conn(&sql, SqlConnPool::Instance());
+    if(!sql) { return; }
+
+    /* 同一批里的重名注册只保留第一个 */
+    unordered_set<string> names;
+    vector<size_t> rows;
+    for(size_t i = 0; i < n; i++) {
+        if(names.insert(items[i].name).second) { rows.push_back(i); }
+    }
+    if(rows.size() == 1) {
+        (*results)[rows[0]] = InsertOne_(sql, items[rows[0]].name, items[rows[0]].pwd);
+        return;
+    }
+
+    /* 多行 INSERT：自动提交模式下单条语句即一个事务，整批只提交一次。
+       行数不定，无法复用预编译语句，值用 mysql_real_escape_string 转义后拼接 */
+    auto escape = [sql](const string& str) {
+        string out(str.size() * 2 + 1, '\0');
+        out.resize(mysql_real_escape_string(sql, &out[0], str.data(), str.size()));
+        return out;
+    };
+    string order = "INSERT INTO user(username, password) VALUES";
+    for(size_t k = 0; k < rows.size(); k++) {
+        const Item& item = items[rows[k]];
+        order += (k ? ",('" : "('") + escape(item.name) + "','" + escape(item.pwd) + "')";
+    }
+    if(mysql_query(sql, order.c_str()) == 0) {
+        for(size_t i : rows) { (*results)[i] = 1; }
+        return;
+    }
+    LOG_WARN("Batch insert of %zu rows failed (%s), retry one by one", rows.size(), mysql_error(sql));
+    for(size_t i : rows) {
+        (*results)[i] = InsertOne_(sql, items[i].name, items[i].pwd);
+    }
+}
+
+bool GroupCommit::InsertOne_(MYSQL* sql, const string& name, const string& pwd) {
+    SqlConnPool* pool = SqlConnPool::Instance();
+    MYSQL_STMT* stmt = pool->GetStmt(sql, SqlConnPool::USER_INSERT);
+    if(!stmt) { return false; }
+    MYSQL_BIND param[2];
+    memset(param, 0, sizeof(param));
+    param[0].buffer_type = MYSQL_TYPE_STRING;
+    param[0].buffer = const_cast<char*>(name.data());
+    param[0].buffer_length = name.size();
+    param[1].buffer_type = MYSQL_TYPE_STRING;
+    param[1].buffer = const_cast<char*>(pwd.data());
+    param[1].buffer_length = pwd.size();
+    if(mysql_stmt_bind_param(stmt, param) || mysql_stmt_execute(stmt)) {
+        LOG_DEBUG("Insert error: %s", mysql_stmt_error(stmt));// 插入失败（如主键冲突）
+        pool->StmtError(sql, SqlConnPool::USER_INSERT);
+        return false;
+    }
+    return true;
+}
+
+GroupCommit::Stats GroupCommit::Take() {
+    Stats stats;
+    stats.batches = batches_.exchange(0, memory_order_relaxed);
+    stats.rows = rows_.exchange(0, memory_order_relaxed);
+    return stats;
+}
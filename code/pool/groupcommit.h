@@ -0,0 +1,81 @@
+#ifndef GROUPCOMMIT_H
+#define GROUPCOMMIT_H
+
+#include <mysql/mysql.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include "sqlconnRAII.h"
+#include "../log/log.h"
+
+// 注册的组提交（group commit）：并发的注册请求合并成一条多行 INSERT，一次提交，再把每行的结果分发给各自的请求。
+//   - 第一个到达的请求成为本批的 leader：没有批次在提交时立即执行；否则等待 windowUs（或凑满 maxBatch）
+//     让其他注册加入，再等上一批提交完成（提交期间到达的注册继续并入本批），然后执行
+//   - 调用者阻塞在阻塞通道的线程上，每个线程同时只有一个注册，所以一批最多合并 dbThreads 个；
+//     WebServer 把 maxBatch 限制在阻塞通道线程数以内（registerBatch 为 0 时直接取该线程数）
+//   - 其余请求（follower）挂在本批上等待结果
+//   - 多行 INSERT 失败（如某个用户名撞了唯一键）时逐行重试，得到每一行各自的结果
+// maxBatch <= 1 时不合并，每个注册单独插入。
+class GroupCommit {
+public:
+    static GroupCommit* Instance();
+
+    struct Item {
+        std::string name;
+        std::string pwd;
+    };
+    // 提交一批注册，results 已按行数填 0，成功的行写 1；不持锁调用，可能有多批并行
+    typedef std::function<void(const std::vector<Item>& items, std::vector<char>* results)> Executor;
+
+    // executor 为空时用 SqlConnPool 的连接执行多行 INSERT（测试中可替换）
+    void Init(size_t maxBatch, int windowUs, Executor executor = nullptr);
+
+    // 插入一个新用户并等待提交结果（阻塞，在阻塞通道线程中调用）
+    bool Insert(const std::string& name, const std::string& pwd);
+
+    // 读取并清零计数（用于周期性输出）
+    struct Stats {
+        uint64_t batches;   // 提交的批数
+        uint64_t rows;      // 提交的注册数
+    };
+    Stats Take();
+    bool Enabled() const { return maxBatch_ > 1; }
+    size_t MaxBatch() const { return maxBatch_; }
+
+private:
+    GroupCommit();
+    ~GroupCommit() = default;
+
+    struct Batch {
+        std::vector<Item> items;
+        std::vector<char> results;
+        std::chrono::steady_clock::time_point deadline;
+        bool done = false;
+    };
+
+    // 执行一批插入，写入 batch->results（不持锁调用）
+    void Execute_(Batch* batch);
+    // 默认的 Executor：多行 INSERT，失败时逐行重试
+    static void ExecuteSql_(const std::vector<Item>& items, std::vector<char>* results);
+    // 用预编译的 USER_INSERT 插入一行
+    static bool InsertOne_(MYSQL* sql, const std::string& name, const std::string& pwd);
+
+    size_t maxBatch_;
+    std::chrono::microseconds window_;
+    Executor executor_;
+
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    std::shared_ptr<Batch> open_;   // 正在收集注册的批次（没有时为空）
+    int flushing_;                  // 正在提交的批数
+
+    std::atomic<uint64_t> batches_;
+    std::atomic<uint64_t> rows_;
+};
+
+#endif //GROUPCOMMIT_H
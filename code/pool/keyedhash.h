@@ -0,0 +1,61 @@
+#ifndef KEYEDHASH_H
+#define KEYEDHASH_H
+
+#include <errno.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/random.h>
+#include "../log/log.h"
+
+// 带密钥的短消息哈希（会话 Cookie 签名、用户缓存中的密码摘要共用）。
+// 密钥由各使用者在启动时用 RandomBytes 生成，只在本进程内有效。
+
+// 读取随机字节（getrandom 在熵池初始化前会阻塞，只在启动和登录时调用）
+inline void RandomBytes(void* buf, size_t len) {
+    char* p = static_cast<char*>(buf);
+    while(len > 0) {
+        ssize_t n = getrandom(p, len, 0);
+        if(n < 0) {
+            if(errno == EINTR) { continue; }
+            LOG_ERROR("getrandom error: %d", errno);
+            abort();
+        }
+        p += n;
+        len -= n;
+    }
+}
+
+inline uint64_t SipRotl(uint64_t x, int b) { return (x << b) | (x >> (64 - b)); }
+
+// SipHash-2-4（Aumasson & Bernstein）
+inline uint64_t SipHash(const uint64_t key[2], const char* data, size_t len) {
+    uint64_t v0 = 0x736f6d6570736575ULL ^ key[0];
+    uint64_t v1 = 0x646f72616e646f6dULL ^ key[1];
+    uint64_t v2 = 0x6c7967656e657261ULL ^ key[0];
+    uint64_t v3 = 0x7465646279746573ULL ^ key[1];
+    auto round = [&] {
+        v0 += v1; v1 = SipRotl(v1, 13); v1 ^= v0; v0 = SipRotl(v0, 32);
+        v2 += v3; v3 = SipRotl(v3, 16); v3 ^= v2;
+        v0 += v3; v3 = SipRotl(v3, 21); v3 ^= v0;
+        v2 += v1; v1 = SipRotl(v1, 17); v1 ^= v2; v2 = SipRotl(v2, 32);
+    };
+    size_t end = len - len % 8;
+    for(size_t i = 0; i < end; i += 8) {
+        uint64_t m = 0;
+        for(int j = 7; j >= 0; j--) { m = (m << 8) | static_cast<unsigned char>(data[i + j]); }
+        v3 ^= m;
+        round(); round();
+        v0 ^= m;
+    }
+    uint64_t b = static_cast<uint64_t>(len) << 56;
+    for(size_t j = len % 8; j > 0; j--) { b |= static_cast<uint64_t>(static_cast<unsigned char>(data[end + j - 1])) << (8 * (j - 1)); }
+    v3 ^= b;
+    round(); round();
+    v0 ^= b;
+    v2 ^= 0xff;
+    round(); round(); round(); round();
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+#endif //KEYEDHASH_H
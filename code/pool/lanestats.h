@@ -0,0 +1,60 @@
+#ifndef LANESTATS_H
+#define LANESTATS_H
+
+#include <atomic>
+#include <chrono>
+#include <utility>
+#include <stdint.h>
+
+// 执行通道（lane）的排队等待统计：任务从提交到开始执行等了多久。
+// Wrap 把任务包一层，执行前记录等待时间；计数用原子变量，工作线程之间不加锁。
+class LaneStats {
+public:
+    struct Snapshot {
+        uint64_t tasks;     // 统计周期内执行的任务数
+        uint64_t avgUs;     // 平均排队时间（微秒）
+        uint64_t maxUs;     // 最大排队时间（微秒）
+    };
+
+    explicit LaneStats(const char* name): name_(name), tasks_(0), waitUs_(0), maxUs_(0) {}
+
+    LaneStats(const LaneStats&) = delete;
+    LaneStats& operator=(const LaneStats&) = delete;
+
+    // 返回包装后的任务（捕获提交时刻）；LaneStats 必须比任务活得久
+    template<class F>
+    auto Wrap(F&& task) {
+        return [this, submit = std::chrono::steady_clock::now(), task = std::forward<F>(task)]() mutable {
+            auto wait = std::chrono::steady_clock::now() - submit;
+            Record(std::chrono::duration_cast<std::chrono::microseconds>(wait).count());
+            task();
+        };
+    }
+
+    void Record(uint64_t us) {
+        tasks_.fetch_add(1, std::memory_order_relaxed);
+        waitUs_.fetch_add(us, std::memory_order_relaxed);
+        uint64_t max = maxUs_.load(std::memory_order_relaxed);
+        while(us > max && !maxUs_.compare_exchange_weak(max, us, std::memory_order_relaxed)) {}
+    }
+
+    // 读取并清零（用于周期性输出）
+    Snapshot Take() {
+        Snapshot s;
+        s.tasks = tasks_.exchange(0, std::memory_order_relaxed);
+        uint64_t wait = waitUs_.exchange(0, std::memory_order_relaxed);
+        s.maxUs = maxUs_.exchange(0, std::memory_order_relaxed);
+        s.avgUs = s.tasks ? wait / s.tasks : 0;
+        return s;
+    }
+
+    const char* Name() const { return name_; }
+
+private:
+    const char* name_;
+    std::atomic<uint64_t> tasks_;
+    std::atomic<uint64_t> waitUs_;
+    std::atomic<uint64_t> maxUs_;
+};
+
+#endif //LANESTATS_H
@@ -0,0 +1,60 @@
+#include "memuserstore.h"
+using namespace std;
+
+MemUserStore::MemUserStore(size_t capacity): capacity_(capacity ? capacity : 1), size_(0) {
+    size_t n = 16;
+    while(n < capacity_ * 2) { n <<= 1; }
+    mask_ = n - 1;
+    slots_.reset(new atomic<Node*>[n]);
+    for(size_t i = 0; i < n; i++) {
+        slots_[i].store(nullptr, memory_order_relaxed);
+    }
+}
+
+MemUserStore::~MemUserStore() {
+    for(size_t i = 0; i <= mask_; i++) {
+        delete slots_[i].load(memory_order_relaxed);
+    }
+}
+
+UserStore::RESULT MemUserStore::Find(const string& name, string* pwd) {
+    for(size_t i = hash<string>()(name) & mask_; ; i = (i + 1) & mask_) {
+        Node* node = slots_[i].load(memory_order_acquire);
+        if(!node) { return NOT_FOUND; }     // 无删除，遇到空槽即可判定不存在
+        if(node->name == name) {
+            *pwd = node->pwd;
+            return FOUND;
+        }
+    }
+}
+
+bool MemUserStore::Insert(const string& name, const string& pwd) {
+    /* 先占名额，保证表里始终留有空槽，探测一定能结束 */
+    if(size_.fetch_add(1, memory_order_relaxed) >= capacity_) {
+        size_.fetch_sub(1, memory_order_relaxed);
+        return false;
+    }
+    Node* node = new Node{name, pwd};
+    for(size_t i = hash<string>()(name) & mask_; ; i = (i + 1) & mask_) {
+        Node* cur = slots_[i].load(memory_order_acquire);
+        if(!cur) {
+            if(slots_[i].compare_exchange_strong(cur, node, memory_order_acq_rel, memory_order_acquire)) {
+                return true;
+            }
+            // CAS 失败时 cur 为抢先写入的节点，继续比较它
+        }
+        if(cur->name == name) {
+            delete node;
+            size_.fetch_sub(1, memory_order_relaxed);
+            return false;
+        }
+    }
+}
+
+bool MemUserStore::LoadNames(vector<string>* names) {
+    for(size_t i = 0; i <= mask_; i++) {
+        Node* node = slots_[i].load(memory_order_acquire);
+        if(node) { names->push_back(node->name); }
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef MEMUSERSTORE_H
+#define MEMUSERSTORE_H
+
+#include <atomic>
+#include <memory>
+#include "userstore.h"
+
+// 进程内用户表：容量固定的开放寻址哈希表，槽位是 atomic<Node*>，
+// 插入用 CAS 抢占空槽（线性探测），不支持删除，因此读路径完全无锁。
+// 数据不落盘，进程退出即丢失；用于在没有数据库的环境下运行和压测。
+class MemUserStore: public UserStore {
+public:
+    // capacity 为最多用户数，槽位数取其 2 倍向上的 2 的幂，装载因子不超过 0.5
+    explicit MemUserStore(size_t capacity);
+    ~MemUserStore();
+
+    RESULT Find(const std::string& name, std::string* pwd) override;
+    bool Insert(const std::string& name, const std::string& pwd) override;
+    bool LoadNames(std::vector<std::string>* names) override;
+    const char* Name() const override { return "memory"; }
+
+private:
+    struct Node {
+        std::string name;
+        std::string pwd;
+    };
+
+    size_t capacity_;
+    size_t mask_;
+    std::atomic<size_t> size_;
+    std::unique_ptr<std::atomic<Node*>[]> slots_;
+};
+
+#endif //MEMUSERSTORE_H
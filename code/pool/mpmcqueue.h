@@ -0,0 +1,113 @@
+#ifndef MPMCQUEUE_H
+#define MPMCQUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <assert.h>
+#include <stdint.h>
+
+// 有界无锁多生产者多消费者环形队列（Dmitry Vyukov 的 bounded MPMC queue）
+// 每个槽位带一个序号：序号 == 入队位置 表示可写，== 出队位置 + 1 表示可读。
+// 队列满时 TryPush 返回 false 而不是扩容，由调用方决定如何反压。
+template<class T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity = 4096): enqueuePos_(0), dequeuePos_(0) {
+        /* 容量向上取整为 2 的幂，下标用掩码计算 */
+        size_t n = 2;
+        while(n < capacity) { n <<= 1; }
+        mask_ = n - 1;
+        cells_.reset(new Cell[n]);
+        for(size_t i = 0; i < n; i++) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    // 队列满返回 false，此时 item 不会被移动
+    template<class U>
+    bool TryPush(U&& item) {
+        return TryEmplace(std::forward<U>(item));
+    }
+
+    // 抢到槽位后才用 args 构造元素；队列满返回 false，args 保持原样
+    template<class... Args>
+    bool TryEmplace(Args&&... args) {
+        Cell* cell;
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        while(true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if(diff == 0) {
+                if(enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_seq_cst)) { break; }
+            }
+            else if(diff < 0) {
+                return false;   // 满
+            }
+            else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = T(std::forward<Args>(args)...);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 队列空返回 false
+    bool TryPop(T& item) {
+        Cell* cell;
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        while(true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if(diff == 0) {
+                if(dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_seq_cst)) { break; }
+            }
+            else if(diff < 0) {
+                return false;   // 空
+            }
+            else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(cell->data);
+        cell->data = T();       // 尽早释放槽位中对象持有的资源
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 近似值：并发修改时只用于判断是否需要唤醒/统计
+    size_t Size() const {
+        size_t e = enqueuePos_.load(std::memory_order_seq_cst);
+        size_t d = dequeuePos_.load(std::memory_order_seq_cst);
+        return e > d ? e - d : 0;
+    }
+
+    bool Empty() const { return Size() == 0; }
+
+    size_t Capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    // 入队与出队位置用填充隔开，分别独占缓存行，避免生产者和消费者互相踩缓存
+    // （用填充而不是 alignas：C++14 的 new 不保证超过 max_align_t 的对齐）
+    static const size_t CACHELINE = 64;
+    char pad0_[CACHELINE];
+    std::atomic<size_t> enqueuePos_;
+    char pad1_[CACHELINE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> dequeuePos_;
+    char pad2_[CACHELINE - sizeof(std::atomic<size_t>)];
+    size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+};
+
+#endif //MPMCQUEUE_H
@@ -0,0 +1,74 @@
+#include "mysqluserstore.h"
+using namespace std;
+
+UserStore::RESULT MySqlUserStore::Find(const string& name, string* pwd) {
+    assert(pwd);
+    SqlConnPool* pool = SqlConnPool::Instance();
+    MYSQL* sql;
+    SqlConnRAII conn(&sql, pool);
+    if(!sql) { return ERROR; }
+    /* 预编译语句 + 参数绑定，用户名不拼进 SQL */
+    MYSQL_STMT* stmt = pool->GetStmt(sql, SqlConnPool::USER_SELECT);
+    if(!stmt) { return ERROR; }
+    MYSQL_BIND param[1];
+    memset(param, 0, sizeof(param));
+    param[0].buffer_type = MYSQL_TYPE_STRING;
+    param[0].buffer = const_cast<char*>(name.data());
+    param[0].buffer_length = name.size();
+
+    char password[256];
+    unsigned long passwordLen = 0;
+    MYSQL_BIND result[1];
+    memset(result, 0, sizeof(result));
+    result[0].buffer_type = MYSQL_TYPE_STRING;
+    result[0].buffer = password;
+    result[0].buffer_length = sizeof(password);
+    result[0].length = &passwordLen;
+
+    if(mysql_stmt_bind_param(stmt, param) || mysql_stmt_bind_result(stmt, result)
+       || mysql_stmt_execute(stmt)) {
+        LOG_ERROR("Select error: %s", mysql_stmt_error(stmt));
+        pool->StmtError(sql, SqlConnPool::USER_SELECT);
+        return ERROR;
+    }
+    RESULT res = NOT_FOUND;
+    int ret;
+    while((ret = mysql_stmt_fetch(stmt)) == 0 || ret == MYSQL_DATA_TRUNCATED) {  // 最多 1 行（LIMIT 1）
+        if(ret == 0) {
+            pwd->assign(password, passwordLen);
+            res = FOUND;
+        } else {
+            LOG_ERROR("Password of %s too long", name.c_str());
+            res = ERROR;
+        }
+    }
+    mysql_stmt_free_result(stmt);   // 释放结果，连接才能执行下一条语句
+    return res;
+}
+
+bool MySqlUserStore::Insert(const string& name, const string& pwd) {
+    // 并发的注册合并成一条多行 INSERT 提交（组提交），等待本行的结果
+    return GroupCommit::Instance()->Insert(name, pwd);
+}
+
+bool MySqlUserStore::LoadNames(vector<string>* names) {
+    assert(names);
+    MYSQL* sql;
+    SqlConnRAII conn(&sql, SqlConnPool::Instance());
+    if(!sql) { return false; }
+    if(mysql_query(sql, "SELECT username FROM user")) {
+        LOG_ERROR("Load user names error: %s", mysql_error(sql));
+        return false;
+    }
+    MYSQL_RES* res = mysql_store_result(sql);
+    if(!res) {
+        LOG_ERROR("Load user names error: %s", mysql_error(sql));
+        return false;
+    }
+    names->reserve(mysql_num_rows(res));
+    while(MYSQL_ROW row = mysql_fetch_row(res)) {
+        if(row[0]) { names->emplace_back(row[0]); }
+    }
+    mysql_free_result(res);
+    return true;
+}
@@ -0,0 +1,19 @@
+#ifndef MYSQLUSERSTORE_H
+#define MYSQLUSERSTORE_H
+
+#include "userstore.h"
+#include "sqlconnRAII.h"
+#include "groupcommit.h"
+#include "../log/log.h"
+
+// MySQL 后端：查询用连接池中连接上预编译的 USER_SELECT，注册经 GroupCommit 合并提交。
+// 连接池需先由 WebServer 初始化。
+class MySqlUserStore: public UserStore {
+public:
+    RESULT Find(const std::string& name, std::string* pwd) override;
+    bool Insert(const std::string& name, const std::string& pwd) override;
+    bool LoadNames(std::vector<std::string>* names) override;
+    const char* Name() const override { return "mysql"; }
+};
+
+#endif //MYSQLUSERSTORE_H
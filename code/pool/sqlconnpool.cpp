@@ -1,7 +1,16 @@
 #include "sqlconnpool.h"
+#include <vector>
 using namespace std;
 
-SqlConnPool::SqlConnPool() : useCount_(0), freeCpunt_(0) {}
+namespace {
+const char* STMT_SQL[SqlConnPool::STMT_COUNT] = {
+    "SELECT password FROM user WHERE username=? LIMIT 1",
+    "INSERT INTO user(username, password) VALUES(?,?)",
+};
+}
+
+SqlConnPool::SqlConnPool() : port_(0), MAX_CONN_(0), total_(0), inUse_(0), peak_(0), connectFailMs_(0),
+    waitStats_("sqlpool"), timeouts_(0), isClose_(false) {}
 
 SqlConnPool *SqlConnPool::Instance()
 {
@@ -9,61 +18,336 @@ SqlConnPool *SqlConnPool::Instance()
     return &connPool;
 }
 
+int64_t SqlConnPool::NowMs_()
+{
+    return chrono::duration_cast<chrono::milliseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 void SqlConnPool::Init(const char *host, int port,
                        const char *user, const char *pwd, const char *dbName,
-                       int connSize)
+                       int connSize, const Options& options)
 {
     assert(connSize > 0);
-    for (int i = 0; i < connSize; i++)
+    host_ = host;
+    port_ = port;
+    user_ = user;
+    pwd_ = pwd;
+    dbName_ = dbName;
+    options_ = options;
+    if (options_.minConn > connSize) { options_.minConn = connSize; }
+    MAX_CONN_ = connSize;
+    // 只建立常驻连接，其余在需要时创建
+    for (int i = 0; i < options_.minConn; i++)
     {
-        MYSQL *sql = nullptr;
-        sql = mysql_init(sql);
+        MYSQL *sql = Connect_();
         if (!sql)
         {
-            LOG_ERROR("MySql init error!");
-            assert(sql);
+            break;
         }
-        sql = mysql_real_connect(sql, host, user, pwd, dbName, port, nullptr, 0);
-        if (!sql)
+        int64_t now = NowMs_();
+        lock_guard<mutex> locker(mtx_);
+        total_++;
+        connQue_.push_back({sql, now, now});
+    }
+    healthThread_ = thread(&SqlConnPool::HealthLoop_, this);
+}
+
+MYSQL* SqlConnPool::Connect_()
+{
+    MYSQL *sql = mysql_init(nullptr);
+    if (!sql)
+    {
+        LOG_ERROR("MySql init error!");
+        return nullptr;
+    }
+    unsigned int timeout = options_.ioTimeoutSec;
+    mysql_options(sql, MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
+    mysql_options(sql, MYSQL_OPT_READ_TIMEOUT, &timeout);
+    mysql_options(sql, MYSQL_OPT_WRITE_TIMEOUT, &timeout);
+    if (!mysql_real_connect(sql, host_.c_str(), user_.c_str(), pwd_.c_str(), dbName_.c_str(), port_, nullptr, 0))
+    {
+        LOG_ERROR("MySql Connect error: %s", mysql_error(sql));
+        mysql_close(sql);
+        return nullptr;
+    }
+    // 每个连接只准备一次，之后每次登录/注册省去服务端的解析和执行计划
+    array<MYSQL_STMT*, STMT_COUNT> stmts;
+    for (int id = 0; id < STMT_COUNT; id++)
+    {
+        stmts[id] = Prepare_(sql, static_cast<STMT>(id));
+    }
+    lock_guard<mutex> locker(mtx_);
+    stmts_[sql] = stmts;
+    return sql;
+}
+
+void SqlConnPool::Close_(MYSQL* conn)
+{
+    array<MYSQL_STMT*, STMT_COUNT> stmts{};
+    {
+        lock_guard<mutex> locker(mtx_);
+        auto it = stmts_.find(conn);
+        if (it != stmts_.end())
         {
-            LOG_ERROR("MySql Connect error!");
+            stmts = it->second;
+            stmts_.erase(it);
         }
-        connQue_.push(sql);
     }
-    MAX_CONN_ = connSize;
-    sem_init(&semId_, 0, MAX_CONN_);
+    for (MYSQL_STMT* stmt : stmts)
+    {
+        if (stmt) { mysql_stmt_close(stmt); }
+    }
+    mysql_close(conn);
 }
 
-MYSQL *SqlConnPool::GetConn()
+MYSQL *SqlConnPool::GetConn(int timeoutMs)
 {
+    if (timeoutMs < 0) { timeoutMs = options_.acquireMs; }
+    auto start = chrono::steady_clock::now();
+    auto deadline = start + chrono::milliseconds(timeoutMs);
+    const int64_t pingMs = static_cast<int64_t>(options_.pingSec) * 1000;
     MYSQL* sql = nullptr;
-    if(connQue_.empty()){
-        LOG_WARN("SqlConnPool busy!");
+    unique_lock<mutex> locker(mtx_);
+    while (!sql)
+    {
+        if (isClose_) { return nullptr; }
+        bool failing = NowMs_() - connectFailMs_ < 1000;
+        if (!connQue_.empty())
+        {
+            Idle idle = connQue_.back();
+            connQue_.pop_back();
+            if (NowMs_() - idle.pingMs < pingMs)
+            {
+                sql = idle.conn;
+                break;
+            }
+            /* 超过 pingSec 没有确认过（后台线程还没轮到它）：借出前先 ping，断开的关闭后继续找 */
+            locker.unlock();
+            bool alive = mysql_ping(idle.conn) == 0;
+            if (!alive)
+            {
+                LOG_WARN("SqlConnPool: connection lost, closing");
+                Close_(idle.conn);
+            }
+            locker.lock();
+            if (alive)
+            {
+                sql = idle.conn;
+                break;
+            }
+            total_--;
+            continue;
+        }
+        /* 没有空闲连接：未到上限时新建（建立连接期间不持锁）；最近刚失败过则不再尝试，只等归还 */
+        if (total_ < MAX_CONN_ && !failing)
+        {
+            total_++;
+            locker.unlock();
+            sql = Connect_();
+            locker.lock();
+            if (!sql)
+            {
+                total_--;
+                connectFailMs_ = NowMs_();
+                /* 数据库连不上：直接失败，不让调用者再等一个期限 */
+                timeouts_.fetch_add(1, memory_order_relaxed);
+                return nullptr;
+            }
+            break;
+        }
+        /* 数据库不可用且没有连接可归还：不必等待 */
+        if (total_ == 0 && failing)
+        {
+            timeouts_.fetch_add(1, memory_order_relaxed);
+            return nullptr;
+        }
+        if (cond_.wait_until(locker, deadline) == cv_status::timeout && connQue_.empty())
+        {
+            timeouts_.fetch_add(1, memory_order_relaxed);
+            LOG_WARN("SqlConnPool busy! (waited %dms)", timeoutMs);
+            return nullptr;
+        }
+    }
+    inUse_++;
+    if (inUse_ > peak_) { peak_ = inUse_; }
+    locker.unlock();
+    waitStats_.Record(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
+    return sql;
+}
+
+void SqlConnPool::FreeConn(MYSQL* sql, bool broken){
+    assert(sql);
+    /* 2000 起是客户端错误（CR_*）：连接已断开或状态不可知，不能交给下一个调用者 */
+    if (mysql_errno(sql) >= 2000) { broken = true; }
+    {
+        lock_guard<mutex> locker(mtx_);
+        if (broken_.erase(sql)) { broken = true; }
+        inUse_--;
+        if (!broken)
+        {
+            int64_t now = NowMs_();
+            connQue_.push_back({sql, now, now});   // 刚无错误地用过，视为已确认可用
+        }
+    }
+    if (broken)
+    {
+        LOG_WARN("SqlConnPool: connection broken during use, closing");
+        Close_(sql);
+        lock_guard<mutex> locker(mtx_);
+        total_--;   // 等待者醒来后可以新建连接
+    }
+    cond_.notify_one();
+}
+
+void SqlConnPool::HealthLoop_(){
+    const int64_t pingMs = static_cast<int64_t>(options_.pingSec) * 1000;
+    const int64_t idleMs = static_cast<int64_t>(options_.idleSec) * 1000;
+    unique_lock<mutex> locker(mtx_);
+    while (!isClose_)
+    {
+        healthCond_.wait_for(locker, chrono::seconds(1));
+        if (isClose_) { break; }
+        /* 多于 minConn 且空闲过久的关闭；其余超过 pingSec 没有确认过的 ping 一次。检查期间连接不在空闲队列中 */
+        int64_t now = NowMs_();
+        int total = total_;
+        deque<Idle> keep;
+        vector<Idle> expired, check;
+        for (const Idle& idle : connQue_)
+        {
+            if (total > options_.minConn && now - idle.sinceMs >= idleMs)
+            {
+                expired.push_back(idle);
+                total--;
+            }
+            else if (now - idle.pingMs >= pingMs) { check.push_back(idle); }
+            else { keep.push_back(idle); }
+        }
+        if (!expired.empty() || !check.empty())
+        {
+            connQue_.swap(keep);
+            locker.unlock();
+            for (const Idle& idle : expired) { Close_(idle.conn); }
+            vector<Idle> alive;
+            for (Idle& idle : check)
+            {
+                if (mysql_ping(idle.conn) == 0)
+                {
+                    idle.pingMs = NowMs_();
+                    alive.push_back(idle);
+                }
+                else
+                {
+                    LOG_WARN("SqlConnPool: connection lost, closing");
+                    Close_(idle.conn);
+                }
+            }
+            locker.lock();
+            total_ -= expired.size() + (check.size() - alive.size());
+            /* 放回队头，仍按空闲时长排在前面 */
+            connQue_.insert(connQue_.begin(), alive.begin(), alive.end());
+            if (!alive.empty()) { cond_.notify_all(); }
+        }
+        /* 补足常驻连接（数据库恢复后重连） */
+        while (!isClose_ && total_ < options_.minConn && NowMs_() - connectFailMs_ >= 1000)
+        {
+            total_++;
+            locker.unlock();
+            MYSQL* sql = Connect_();
+            locker.lock();
+            if (!sql)
+            {
+                total_--;
+                connectFailMs_ = NowMs_();
+                break;
+            }
+            connQue_.push_back({sql, NowMs_(), NowMs_()});
+            cond_.notify_one();
+        }
+    }
+}
+
+MYSQL_STMT* SqlConnPool::Prepare_(MYSQL* conn, STMT id){
+    MYSQL_STMT* stmt = mysql_stmt_init(conn);
+    if(!stmt) {
+        LOG_ERROR("MySql stmt init error!");
+        return nullptr;
+    }
+    if(mysql_stmt_prepare(stmt, STMT_SQL[id], strlen(STMT_SQL[id]))) {
+        LOG_ERROR("MySql prepare error: %s", mysql_stmt_error(stmt));
+        mysql_stmt_close(stmt);
         return nullptr;
     }
-    sem_wait(&semId_);
+    return stmt;
+}
+
+MYSQL_STMT* SqlConnPool::GetStmt(MYSQL* conn, STMT id){
+    assert(conn && id < STMT_COUNT);
+    MYSQL_STMT** slot;
     {
+        /* 连接可能随时新建/关闭，查表需加锁；元素的地址在表扩容时不变 */
         lock_guard<mutex> locker(mtx_);
-        sql = connQue_.front();
-        connQue_.pop();
+        auto it = stmts_.find(conn);
+        if(it == stmts_.end()) { return nullptr; }
+        slot = &it->second[id];
     }
-    return sql;
+    if(!*slot) { *slot = Prepare_(conn, id); }
+    return *slot;
 }
 
-void SqlConnPool::FreeConn(MYSQL* sql){
-    assert(sql);
+void SqlConnPool::StmtError(MYSQL* conn, STMT id){
+    assert(conn && id < STMT_COUNT);
+    MYSQL_STMT** slot;
+    {
+        lock_guard<mutex> locker(mtx_);
+        auto it = stmts_.find(conn);
+        if(it == stmts_.end()) { return; }
+        slot = &it->second[id];
+    }
+    /* 服务端错误（如唯一键冲突）语句仍可用；2000 起是客户端错误（CR_*），语句和连接都可能已失效 */
+    if(*slot && mysql_stmt_errno(*slot) >= 2000) {
+        mysql_stmt_close(*slot);
+        *slot = nullptr;
+        lock_guard<mutex> locker(mtx_);
+        broken_.insert(conn);
+    }
+}
+
+SqlConnPool::Stats SqlConnPool::TakeStats(){
+    Stats stats;
+    stats.wait = waitStats_.Take();
+    stats.timeouts = timeouts_.exchange(0, memory_order_relaxed);
     lock_guard<mutex> locker(mtx_);
-    connQue_.push(sql);
-    sem_post(&semId_);
+    stats.inUse = inUse_;
+    stats.peak = peak_;
+    stats.total = total_;
+    stats.maxConn = MAX_CONN_;
+    peak_ = inUse_;
+    return stats;
 }
+
 void SqlConnPool::ClosePool(){
+    {
+        lock_guard<mutex> locker(mtx_);
+        isClose_ = true;
+    }
+    healthCond_.notify_all();
+    cond_.notify_all();
+    if(healthThread_.joinable()) { healthThread_.join(); }
     lock_guard<mutex> locker(mtx_);
+    for(auto& item : stmts_) {
+        for(MYSQL_STMT* stmt : item.second) {
+            if(stmt) { mysql_stmt_close(stmt); }
+        }
+    }
+    stmts_.clear();
+    broken_.clear();
     while(!connQue_.empty()) {
         auto item = connQue_.front();
-        connQue_.pop();
-        mysql_close(item);
+        connQue_.pop_front();
+        mysql_close(item.conn);
     }
-    mysql_library_end();    
+    mysql_library_end();
 }
 int SqlConnPool::GetFreeConnCount() {
     lock_guard<mutex> locker(mtx_);
@@ -71,4 +355,4 @@ int SqlConnPool::GetFreeConnCount() {
 }
 SqlConnPool::~SqlConnPool() {
     ClosePool();
-}
\ No newline at end of file
+}
@@ -3,34 +3,116 @@
 
 #include<mysql/mysql.h>
 #include<cstring>
-#include<queue>
+#include<string>
+#include<deque>
+#include<array>
+#include<unordered_map>
+#include<unordered_set>
 #include<mutex>
-#include<semaphore.h>
+#include<condition_variable>
+#include<atomic>
 #include<thread>
+#include"lanestats.h"
 #include"../log/log.h"
 
+// 数据库连接池：
+//   - 连接按需创建：启动时只建 minConn 个，取不到空闲连接且未到上限时再新建
+//   - 取连接有期限：超时返回 nullptr（快速失败），不会让工作线程无限期卡在数据库上
+//   - 后台线程定期 ping 空闲连接，断开的连接关闭后按需重连；多于 minConn 的连接空闲过久被关闭
+//   - 使用中出现客户端错误（连接断开）的连接归还时直接关闭；超过 pingSec 未确认的连接借出前先 ping。
+//     不开启 MYSQL_OPT_RECONNECT：自动重连会丢掉连接上预编译的语句，改为关闭后新建
+//   - 统计取连接的等待时间、超时次数和连接使用率
 class SqlConnPool{
 public:
+    // 每个连接上预编译的语句（建立连接时准备好，随连接一起复用，参数绑定执行，不再拼接 SQL）
+    enum STMT {
+        USER_SELECT,    // SELECT password FROM user WHERE username=? LIMIT 1
+        USER_INSERT,    // INSERT INTO user(username, password) VALUES(?,?)
+        STMT_COUNT
+    };
+
+    struct Options {
+        Options(): minConn(2), acquireMs(500), ioTimeoutSec(3), pingSec(30), idleSec(60) {}
+        int minConn;        // 常驻连接数（启动时建立，空闲也不关闭）
+        int acquireMs;      // GetConn 默认的等待期限
+        int ioTimeoutSec;   // 连接/读/写超时，数据库卡住时查询在此时间内失败
+        int pingSec;        // 空闲超过该时间的连接由后台线程 ping 一次
+        int idleSec;        // 多于 minConn 的连接空闲超过该时间后关闭
+    };
+
+    struct Stats {
+        LaneStats::Snapshot wait;   // 取连接的等待时间
+        uint64_t timeouts;          // 取连接超时（或新建连接失败）次数
+        int inUse;                  // 当前借出的连接数
+        int peak;                   // 统计周期内借出连接数的峰值
+        int total;                  // 当前已建立的连接数
+        int maxConn;
+    };
+
     static SqlConnPool* Instance();
-    MYSQL *GetConn();
-    void FreeConn(MYSQL* conn);
+    // 取一个连接，最多等待 timeoutMs（-1 使用 Options::acquireMs）；超时或无法建立连接时返回 nullptr
+    MYSQL *GetConn(int timeoutMs = -1);
+    // 归还连接；broken 为 true、连接最近一次操作是客户端错误（CR_*，如 CR_SERVER_GONE_ERROR）
+    // 或 StmtError 报告过客户端错误时关闭该连接，不再借给下一个调用者
+    void FreeConn(MYSQL* conn, bool broken = false);
     int GetFreeConnCount();
     void Init(const char* host, int port,
               const char* user, const char* pwd,
-              const char* dbName, int connSize = 10);
+              const char* dbName, int connSize = 10,
+              const Options& options = Options());
     void ClosePool();
+    // 读取统计并开始新的统计周期
+    Stats TakeStats();
+
+    // 取 conn 上预编译的语句（只能由持有该连接的线程调用）；没有准备好时重新准备，失败返回 nullptr
+    MYSQL_STMT* GetStmt(MYSQL* conn, STMT id);
+    // 语句执行出错后调用：客户端错误（连接断开等）时丢弃该语句，并把连接标记为断开（归还时关闭）
+    void StmtError(MYSQL* conn, STMT id);
 
 private:
     SqlConnPool();
     ~SqlConnPool();
 
+    static MYSQL_STMT* Prepare_(MYSQL* conn, STMT id);
+    // 建立一个新连接并准备语句（不持锁调用），失败返回 nullptr
+    MYSQL* Connect_();
+    // 关闭连接及其语句（不持锁调用，连接不在空闲队列中）
+    void Close_(MYSQL* conn);
+    // 后台线程：ping 空闲连接、关闭多余连接、补足 minConn
+    void HealthLoop_();
+    static int64_t NowMs_();
+
+    struct Idle {
+        MYSQL* conn;
+        int64_t sinceMs;    // 归还的时刻
+        int64_t pingMs;     // 上次确认可用（无错误归还或 ping 成功）的时刻
+    };
+
+    std::string host_, user_, pwd_, dbName_;
+    int port_;
+    Options options_;
+
     int MAX_CONN_;
-    int useCount_;
-    int freeCpunt_;
+    int total_;             // 已建立（含正在建立）的连接数
+    int inUse_;
+    int peak_;
+    int64_t connectFailMs_; // 上次建立连接失败的时刻，1 秒内不再尝试新建
 
-    std::queue<MYSQL*> connQue_;
+    std::deque<Idle> connQue_;  // 空闲连接：尾部最近归还，取连接从尾部取，后台线程从头部检查
     std::mutex mtx_;
-    sem_t semId_;
+    std::condition_variable cond_;
+
+    // 连接 -> 该连接上的预编译语句；表结构在 mtx_ 下修改，元素只由持有连接的线程读写
+    std::unordered_map<MYSQL*, std::array<MYSQL_STMT*, STMT_COUNT>> stmts_;
+    // StmtError 发现已断开、等待归还时关闭的连接
+    std::unordered_set<MYSQL*> broken_;
+
+    LaneStats waitStats_;
+    std::atomic<uint64_t> timeouts_;
+
+    bool isClose_;
+    std::condition_variable healthCond_;
+    std::thread healthThread_;
 };
 
-#endif // SQLCONNPOOL_H
\ No newline at end of file
+#endif // SQLCONNPOOL_H
@@ -0,0 +1,91 @@
+#include "sqliteuserstore.h"
+using namespace std;
+
+SqliteUserStore::SqliteUserStore(): db_(nullptr), select_(nullptr), insert_(nullptr) {}
+
+SqliteUserStore::~SqliteUserStore() {
+    Close_();
+}
+
+void SqliteUserStore::Close_() {
+    sqlite3_finalize(select_);
+    sqlite3_finalize(insert_);
+    sqlite3_close(db_);
+    select_ = insert_ = nullptr;
+    db_ = nullptr;
+}
+
+bool SqliteUserStore::Open(const string& file) {
+    lock_guard<mutex> locker(mtx_);
+    if(sqlite3_open(file.c_str(), &db_) != SQLITE_OK) {
+        LOG_ERROR("SQLite open %s error: %s", file.c_str(), sqlite3_errmsg(db_));
+        Close_();
+        return false;
+    }
+    const char* init =
+        "PRAGMA journal_mode=WAL;"
+        "PRAGMA synchronous=NORMAL;"
+        "CREATE TABLE IF NOT EXISTS user(username TEXT PRIMARY KEY, password TEXT NOT NULL);";
+    char* err = nullptr;
+    if(sqlite3_exec(db_, init, nullptr, nullptr, &err) != SQLITE_OK
+       || sqlite3_prepare_v2(db_, "SELECT password FROM user WHERE username=? LIMIT 1", -1, &select_, nullptr) != SQLITE_OK
+       || sqlite3_prepare_v2(db_, "INSERT INTO user(username, password) VALUES(?,?)", -1, &insert_, nullptr) != SQLITE_OK) {
+        LOG_ERROR("SQLite init %s error: %s", file.c_str(), err ? err : sqlite3_errmsg(db_));
+        sqlite3_free(err);
+        Close_();
+        return false;
+    }
+    return true;
+}
+
+UserStore::RESULT SqliteUserStore::Find(const string& name, string* pwd) {
+    assert(pwd);
+    lock_guard<mutex> locker(mtx_);
+    if(!db_) { return ERROR; }
+    sqlite3_bind_text(select_, 1, name.data(), name.size(), SQLITE_STATIC);
+    RESULT res;
+    int rc = sqlite3_step(select_);
+    if(rc == SQLITE_ROW) {
+        const char* text = reinterpret_cast<const char*>(sqlite3_column_text(select_, 0));
+        pwd->assign(text ? text : "", sqlite3_column_bytes(select_, 0));
+        res = FOUND;
+    } else if(rc == SQLITE_DONE) {
+        res = NOT_FOUND;
+    } else {
+        LOG_ERROR("SQLite select error: %s", sqlite3_errmsg(db_));
+        res = ERROR;
+    }
+    sqlite3_reset(select_);
+    return res;
+}
+
+bool SqliteUserStore::Insert(const string& name, const string& pwd) {
+    lock_guard<mutex> locker(mtx_);
+    if(!db_) { return false; }
+    sqlite3_bind_text(insert_, 1, name.data(), name.size(), SQLITE_STATIC);
+    sqlite3_bind_text(insert_, 2, pwd.data(), pwd.size(), SQLITE_STATIC);
+    int rc = sqlite3_step(insert_);
+    if(rc != SQLITE_DONE) {
+        LOG_DEBUG("SQLite insert error: %s", sqlite3_errmsg(db_));  // 用户名已存在时为 UNIQUE 约束失败
+    }
+    sqlite3_reset(insert_);
+    return rc == SQLITE_DONE;
+}
+
+bool SqliteUserStore::LoadNames(vector<string>* names) {
+    assert(names);
+    lock_guard<mutex> locker(mtx_);
+    if(!db_) { return false; }
+    sqlite3_stmt* stmt = nullptr;
+    if(sqlite3_prepare_v2(db_, "SELECT username FROM user", -1, &stmt, nullptr) != SQLITE_OK) {
+        LOG_ERROR("SQLite load names error: %s", sqlite3_errmsg(db_));
+        return false;
+    }
+    int rc;
+    while((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        if(text) { names->emplace_back(text, sqlite3_column_bytes(stmt, 0)); }
+    }
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+}
@@ -0,0 +1,34 @@
+#ifndef SQLITEUSERSTORE_H
+#define SQLITEUSERSTORE_H
+
+#include <sqlite3.h>
+#include <mutex>
+#include "userstore.h"
+#include "../log/log.h"
+
+// 嵌入式 SQLite 后端：单个数据库文件，启动时自动建表，不需要数据库服务。
+// 一个连接 + 两条预编译语句，由互斥锁串行化（SQLite 写入本身也是串行的）；
+// WAL + synchronous=NORMAL，注册不必每次 fsync。
+class SqliteUserStore: public UserStore {
+public:
+    SqliteUserStore();
+    ~SqliteUserStore();
+
+    // 打开（不存在时创建）数据库文件并准备语句
+    bool Open(const std::string& file);
+
+    RESULT Find(const std::string& name, std::string* pwd) override;
+    bool Insert(const std::string& name, const std::string& pwd) override;
+    bool LoadNames(std::vector<std::string>* names) override;
+    const char* Name() const override { return "sqlite"; }
+
+private:
+    void Close_();
+
+    std::mutex mtx_;
+    sqlite3* db_;
+    sqlite3_stmt* select_;
+    sqlite3_stmt* insert_;
+};
+
+#endif //SQLITEUSERSTORE_H
@@ -0,0 +1,88 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <new>
+#include <utility>
+#include <cstddef>
+#include <type_traits>
+#include <assert.h>
+
+// 固定大小的小缓冲任务类型：可调用对象直接放在内部缓冲区里，从不申请堆内存。
+// std::function 在捕获较大（如 std::bind(&WebServer::OnRead_, this, client)）时可能 new，
+// Task 则在编译期检查大小，放不下直接编译失败。只支持移动，不支持拷贝。
+class Task {
+public:
+    // 内部缓冲区大小：足够容纳 成员函数指针 + this + 参数 + 一个 std::function
+    static const size_t STORAGE = 64;
+
+    Task() noexcept: ops_(nullptr) {}
+
+    template<class F, class D = typename std::decay<F>::type,
+             class = typename std::enable_if<!std::is_same<D, Task>::value>::type>
+    Task(F&& f): ops_(OpsOf<D>()) {
+        static_assert(sizeof(D) <= STORAGE, "callable too large for Task, enlarge Task::STORAGE");
+        static_assert(alignof(D) <= alignof(std::max_align_t), "callable over-aligned for Task");
+        new (&storage_) D(std::forward<F>(f));
+    }
+
+    Task(Task&& other) noexcept: ops_(other.ops_) {
+        if(ops_) {
+            ops_->move(&storage_, &other.storage_);
+            other.Reset_();
+        }
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if(this != &other) {
+            Reset_();
+            ops_ = other.ops_;
+            if(ops_) {
+                ops_->move(&storage_, &other.storage_);
+                other.Reset_();
+            }
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { Reset_(); }
+
+    void operator()() {
+        assert(ops_);
+        ops_->invoke(&storage_);
+    }
+
+    explicit operator bool() const { return ops_ != nullptr; }
+
+private:
+    struct Ops {
+        void (*invoke)(void* self);
+        void (*move)(void* dst, void* src);     // 从 src 移动构造到 dst（src 随后由 Reset_ 析构）
+        void (*destroy)(void* self);
+    };
+
+    template<class D>
+    static const Ops* OpsOf() {
+        static const Ops ops = {
+            [](void* self) { (*static_cast<D*>(self))(); },
+            [](void* dst, void* src) { new (dst) D(std::move(*static_cast<D*>(src))); },
+            [](void* self) { static_cast<D*>(self)->~D(); },
+        };
+        return &ops;
+    }
+
+    // 析构当前持有的可调用对象
+    void Reset_() {
+        if(ops_) {
+            ops_->destroy(&storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    typename std::aligned_storage<STORAGE, alignof(std::max_align_t)>::type storage_;
+    const Ops* ops_;
+};
+
+#endif //TASK_H
@@ -4,35 +4,48 @@
 
 #include <mutex>
 #include <condition_variable>
-#include <queue>
 #include <thread>
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <memory>
+#include <assert.h>
+#include <stdint.h>
+#include "task.h"
+#include "mpmcqueue.h"
 class ThreadPool {
 public:
-    explicit ThreadPool(size_t threadCount = 8): pool_(std::make_shared<Pool>()) {
+    // 弹性模式：线程数在 [minThreads, maxThreads] 之间自动伸缩
+    //   - 扩容：任务排队时间超过 targetWaitUs（或所有线程都在忙且这么久没取走任务）时加一个线程
+    //   - 缩容：线程空闲 idleMs 仍没有任务时退出，直到剩 minThreads 个
+    // 每次伸缩调用 report(当前线程数, "grow"/"shrink", 触发时的排队时间 us)
+    struct Elastic {
+        Elastic(): minThreads(0), maxThreads(0), targetWaitUs(2000), idleMs(30000) {}
+        size_t minThreads;
+        size_t maxThreads;          // 0 表示不开启弹性模式
+        int64_t targetWaitUs;
+        int idleMs;
+        std::function<void(size_t threads, const char* decision, int64_t waitUs)> report;
+    };
+
+    // queueSize: 任务队列容量（有界无锁环形队列），满时 TryAdd 返回 false
+    explicit ThreadPool(size_t threadCount = 8, size_t queueSize = 4096, const Elastic& elastic = Elastic())
+        : pool_(std::make_shared<Pool>(queueSize, elastic)) {
             assert(threadCount > 0);
+            if(pool_->elastic) {
+                assert(elastic.minThreads > 0 && elastic.minThreads <= elastic.maxThreads);
+                if(threadCount < elastic.minThreads) { threadCount = elastic.minThreads; }
+                if(threadCount > elastic.maxThreads) { threadCount = elastic.maxThreads; }
+            }
             for(size_t i = 0; i < threadCount; i++) {
-                std::thread([pool = pool_] {
-                    std::unique_lock<std::mutex> locker(pool->mtx);
-                    while(true) {
-                        if(!pool->tasks.empty()) {
-                            auto task = std::move(pool->tasks.front());
-                            pool->tasks.pop();
-                            locker.unlock();
-                            task();
-                            locker.lock();
-                        } 
-                        else if(pool->isClosed) break;
-                        else pool->cond.wait(locker);
-                    }
-                }).detach();
+                pool_->Spawn();
             }
     }
 
     ThreadPool() = default;
 
     ThreadPool(ThreadPool&&) = default;
-    
+
     ~ThreadPool() {
         if(static_cast<bool>(pool_)) {
             {
@@ -43,24 +56,147 @@ public:
         }
     }
 
+    // 队列满时让出 CPU 重试，直到放入为止（不丢任务）
     template<class F>
     void AddTask(F&& task) {
-        {
-            std::lock_guard<std::mutex> locker(pool_->mtx);
-            pool_->tasks.emplace(std::forward<F>(task));
+        while(!TryAdd(std::forward<F>(task))) {
+            std::this_thread::yield();
         }
-        pool_->cond.notify_one();
     }
 
+    // 队列满时立即返回 false，task 保持原样，由调用方决定反压策略
+    template<class F>
+    bool TryAdd(F&& task) {
+        int64_t now = pool_->elastic ? NowUs() : 0;
+        if(!pool_->tasks.TryEmplace(std::forward<F>(task), now)) {
+            return false;
+        }
+        if(pool_->idle.load() > 0) {
+            pool_->Notify();
+        }
+        else if(pool_->elastic) {
+            /* 没有空闲线程且队列已经这么久没被取走：线程可能全阻塞在慢操作上，扩容 */
+            int64_t stall = now - pool_->lastPopUs.load(std::memory_order_relaxed);
+            if(stall > pool_->targetWaitUs) { pool_->Grow(now, stall); }
+        }
+        return true;
+    }
+
+    size_t QueueSize() const { return pool_->tasks.Size(); }
+
+    size_t Threads() const { return pool_->threads.load(); }
+
 private:
-    struct Pool {
+    static int64_t NowUs() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 队列元素：任务 + 入队时刻（仅弹性模式记录，用于计算排队时间）
+    struct Entry {
+        Entry(): enqueueUs(0) {}
+        template<class F>
+        Entry(F&& f, int64_t now): task(std::forward<F>(f)), enqueueUs(now) {}
+        Task task;
+        int64_t enqueueUs;
+    };
+
+    struct Pool: std::enable_shared_from_this<Pool> {
+        Pool(size_t queueSize, const Elastic& e): isClosed(false), idle(0), threads(0),
+            elastic(e.maxThreads > 0), minThreads(e.minThreads), maxThreads(e.maxThreads),
+            targetWaitUs(e.targetWaitUs), idleMs(e.idleMs), report(e.report),
+            lastPopUs(NowUs()), lastGrowUs(0), tasks(queueSize) {}
+
+        // 只有存在空闲线程时才加锁唤醒；所有线程都在忙时入队完全无锁
+        void Notify() {
+            { std::lock_guard<std::mutex> locker(mtx); }
+            cond.notify_one();
+        }
+
+        void Spawn() {
+            threads++;
+            std::thread([pool = shared_from_this()] { pool->Run(); }).detach();
+        }
+
+        // 加一个线程；两次扩容至少间隔 targetWaitUs，让新线程有机会先消化积压
+        void Grow(int64_t now, int64_t waitUs) {
+            int64_t last = lastGrowUs.load(std::memory_order_relaxed);
+            if(now - last < targetWaitUs || !lastGrowUs.compare_exchange_strong(last, now)) { return; }
+            size_t n = threads.load();
+            do {
+                if(n >= maxThreads) { return; }
+            } while(!threads.compare_exchange_weak(n, n + 1));
+            std::thread([pool = shared_from_this()] { pool->Run(); }).detach();
+            if(report) { report(n + 1, "grow", waitUs); }
+        }
+
+        // 空闲超时后尝试退出；线程数已到下限返回 false
+        bool Shrink() {
+            size_t n = threads.load();
+            do {
+                if(n <= minThreads) { return false; }
+            } while(!threads.compare_exchange_weak(n, n - 1));
+            return true;
+        }
+
+        void Run() {
+            Entry entry;
+            while(true) {
+                if(tasks.TryPop(entry)) {
+                    if(elastic) {
+                        int64_t now = NowUs();
+                        lastPopUs.store(now, std::memory_order_relaxed);
+                        if(now - entry.enqueueUs > targetWaitUs) { Grow(now, now - entry.enqueueUs); }
+                    }
+                    entry.task();
+                    entry.task = Task();
+                    continue;
+                }
+                /* 队列为空：登记为空闲后在锁内再检查一次，避免与 AddTask 交错丢失唤醒 */
+                bool retire = false;
+                {
+                    std::unique_lock<std::mutex> locker(mtx);
+                    idle++;
+                    while(!isClosed && tasks.Empty()) {
+                        if(!elastic) {
+                            cond.wait(locker);
+                        }
+                        else if(cond.wait_for(locker, std::chrono::milliseconds(idleMs)) == std::cv_status::timeout
+                                && tasks.Empty() && Shrink()) {
+                            retire = true;
+                            break;
+                        }
+                    }
+                    idle--;
+                    if(!retire && isClosed && tasks.Empty()) { break; }
+                }
+                if(retire) {
+                    if(report) { report(threads.load(), "shrink", 0); }
+                    return;
+                }
+            }
+            threads--;
+        }
+
         std::mutex mtx;
         std::condition_variable cond;
         bool isClosed;
-        std::queue<std::function<void()>> tasks;
+        std::atomic<int> idle;          // 挂起等待任务的线程数
+        std::atomic<size_t> threads;    // 当前线程数
+
+        const bool elastic;
+        const size_t minThreads;
+        const size_t maxThreads;
+        const int64_t targetWaitUs;
+        const int idleMs;
+        const std::function<void(size_t, const char*, int64_t)> report;
+        std::atomic<int64_t> lastPopUs;     // 最近一次取走任务的时刻
+        std::atomic<int64_t> lastGrowUs;    // 最近一次扩容的时刻
+
+        MpmcQueue<Entry> tasks;
     };
     std::shared_ptr<Pool> pool_;
 };
 
 
-#endif //THREADPOOL_H
\ No newline at end of file
+#endif //THREADPOOL_H
@@ -0,0 +1,124 @@
+#include "usercache.h"
+#include "keyedhash.h"
+#include <chrono>
+using namespace std;
+
+UserCache::UserCache(): capacity_(0), ttlMs_(0), bitCount_(0), filterOn_(false),
+    hits_(0), misses_(0), filtered_(0) {
+    RandomBytes(key_, sizeof(key_));
+}
+
+UserCache* UserCache::Instance() {
+    static UserCache cache;
+    return &cache;
+}
+
+void UserCache::Init(size_t capacity, int ttlSec) {
+    capacity_ = (capacity + SHARD_COUNT - 1) / SHARD_COUNT;
+    ttlMs_ = static_cast<int64_t>(ttlSec) * 1000;
+}
+
+bool UserCache::LoadFilter(UserStore* store) {
+    vector<string> names;
+    if(!store || !store->LoadNames(&names)) { return false; }
+    /* 按现有用户数的 2 倍预留（至少 64K 个），给之后的注册留余量；超出后误判率上升但不会漏判 */
+    size_t expect = max<size_t>(names.size() * 2, 1 << 16);
+    bitCount_ = (expect * BITS_PER_NAME + 63) / 64 * 64;
+    bits_.reset(new atomic<uint64_t>[bitCount_ / 64]);
+    for(size_t i = 0; i < bitCount_ / 64; i++) {
+        bits_[i].store(0, memory_order_relaxed);
+    }
+    for(const string& name : names) {
+        AddName_(hash<string>()(name));
+    }
+    filterOn_.store(true, memory_order_release);
+    LOG_INFO("UserCache filter: %zu names, %zu KB", names.size(), bitCount_ / 8 / 1024);
+    return true;
+}
+
+int64_t UserCache::NowMs_() {
+    return chrono::duration_cast<chrono::milliseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t UserCache::PwdHash_(const string& pwd) const {
+    return SipHash(key_, pwd.data(), pwd.size());
+}
+
+bool UserCache::Get(const string& name, const string& pwd, bool* match) {
+    assert(match);
+    if(capacity_ == 0) { return false; }
+    Shard& shard = ShardOf_(hash<string>()(name));
+    {
+        lock_guard<mutex> locker(shard.mtx);
+        auto it = shard.index.find(name);
+        if(it != shard.index.end()) {
+            if(it->second->expireMs > NowMs_()) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                *match = it->second->pwdHash == PwdHash_(pwd);
+                hits_.fetch_add(1, memory_order_relaxed);
+                return true;
+            }
+            /* 已过期：删掉，回数据库取最新的 */
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+        }
+    }
+    misses_.fetch_add(1, memory_order_relaxed);
+    return false;
+}
+
+void UserCache::Put(const string& name, const string& pwd) {
+    size_t h = hash<string>()(name);
+    if(FilterEnabled()) { AddName_(h); }
+    if(capacity_ == 0) { return; }
+    Shard& shard = ShardOf_(h);
+    int64_t expire = NowMs_() + ttlMs_;
+    uint64_t pwdHash = PwdHash_(pwd);
+    lock_guard<mutex> locker(shard.mtx);
+    auto it = shard.index.find(name);
+    if(it != shard.index.end()) {
+        it->second->pwdHash = pwdHash;
+        it->second->expireMs = expire;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+    if(shard.index.size() >= capacity_) {
+        /* 淘汰最久未使用的 */
+        shard.index.erase(shard.lru.back().name);
+        shard.lru.pop_back();
+    }
+    shard.lru.push_front(Entry{name, pwdHash, expire});
+    shard.index[name] = shard.lru.begin();
+}
+
+/* 双重哈希生成第 i 个位置：h1 + i * h2（h2 由 h1 再混合一次得到，取奇数） */
+size_t UserCache::BitOf_(size_t hash, int i) const {
+    uint64_t h2 = (static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> 17 | 1;
+    return (hash + i * h2) % bitCount_;
+}
+
+void UserCache::AddName_(size_t hash) {
+    for(int i = 0; i < HASH_COUNT; i++) {
+        size_t bit = BitOf_(hash, i);
+        bits_[bit / 64].fetch_or(1ULL << (bit % 64), memory_order_relaxed);
+    }
+}
+
+bool UserCache::MayExist(const string& name) const {
+    if(!FilterEnabled()) { return true; }
+    size_t h = hash<string>()(name);
+    for(int i = 0; i < HASH_COUNT; i++) {
+        size_t bit = BitOf_(h, i);
+        if(!(bits_[bit / 64].load(memory_order_relaxed) & (1ULL << (bit % 64)))) { return false; }
+    }
+    return true;
+}
+
+UserCache::Stats UserCache::Take() {
+    Stats stats;
+    stats.hits = hits_.exchange(0, memory_order_relaxed);
+    stats.misses = misses_.exchange(0, memory_order_relaxed);
+    stats.filtered = filtered_.exchange(0, memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,88 @@
+#ifndef USERCACHE_H
+#define USERCACHE_H
+
+#include <string>
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include "../log/log.h"
+#include "userstore.h"
+
+// 进程内的用户缓存，登录/注册在查数据库之前先查这里：
+//   - 用户记录缓存：按用户名分片加锁，每片 LRU 限制条目数，条目超过 TTL 作废；注册成功时写入（write-through）。
+//     只保存密码的带密钥摘要（SipHash，密钥启动时随机生成），不保存明文。
+//     其他途径修改的密码在条目过期（TTL）之前，旧密码仍能登录
+//   - 用户名布隆过滤器：启动时从数据库载入全部用户名，之后注册的用户名随写入加入。
+//     过滤器说“不存在”时一定不存在：未知用户的登录直接失败、注册直接插入，都省去一次查询。
+//     前提是本进程是 user 表唯一的写入者（其他途径新增的用户在重启前会被误判为不存在），因此过滤器需显式开启。
+class UserCache {
+public:
+    static UserCache* Instance();
+
+    // capacity 为总条目上限（平均分到各分片），为 0 时不缓存记录；ttlSec 为条目有效期
+    void Init(size_t capacity, int ttlSec);
+    // 从用户存储载入全部用户名建立过滤器（启动时调用）；失败时过滤器保持关闭
+    bool LoadFilter(UserStore* store);
+
+    // 命中时返回 true，*match 为 pwd 是否与缓存的密码一致
+    bool Get(const std::string& name, const std::string& pwd, bool* match);
+    // 写入（或刷新）用户记录，同时把用户名加入过滤器
+    void Put(const std::string& name, const std::string& pwd);
+    // 过滤器判断用户名是否可能存在；返回 false 表示一定不存在（过滤器未开启时总是返回 true）
+    bool MayExist(const std::string& name) const;
+
+    // 读取并清零计数（用于周期性输出）
+    struct Stats {
+        uint64_t hits;      // 记录缓存命中
+        uint64_t misses;    // 记录缓存未命中
+        uint64_t filtered;  // 过滤器确定不存在，省去查询
+    };
+    Stats Take();
+    void Filtered() { filtered_.fetch_add(1, std::memory_order_relaxed); }
+    bool Enabled() const { return capacity_ > 0; }
+    bool FilterEnabled() const { return filterOn_.load(std::memory_order_acquire); }
+
+private:
+    UserCache();
+    ~UserCache() = default;
+
+    struct Entry {
+        std::string name;
+        uint64_t pwdHash;       // PwdHash_(pwd)
+        int64_t expireMs;
+    };
+    struct Shard {
+        std::mutex mtx;
+        std::list<Entry> lru;   // 头部为最近使用
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    };
+
+    Shard& ShardOf_(size_t hash) { return shards_[hash % SHARD_COUNT]; }
+    size_t BitOf_(size_t hash, int i) const;
+    void AddName_(size_t hash);
+    static int64_t NowMs_();
+    uint64_t PwdHash_(const std::string& pwd) const;
+
+    static const size_t SHARD_COUNT = 16;
+    static const int HASH_COUNT = 7;        // 每个用户名置 7 位，约 10 位/用户时误判率约 1%
+    static const size_t BITS_PER_NAME = 10;
+
+    Shard shards_[SHARD_COUNT];
+    size_t capacity_;           // 每个分片的条目上限
+    int64_t ttlMs_;
+    uint64_t key_[2];           // 密码摘要的密钥
+
+    std::unique_ptr<std::atomic<uint64_t>[]> bits_;
+    size_t bitCount_;
+    std::atomic<bool> filterOn_;
+
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<uint64_t> filtered_;
+};
+
+#endif //USERCACHE_H
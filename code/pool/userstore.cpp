@@ -0,0 +1,14 @@
+#include "userstore.h"
+using namespace std;
+
+namespace {
+unique_ptr<UserStore> g_store;
+}
+
+UserStore* UserStore::Instance() {
+    return g_store.get();
+}
+
+void UserStore::Set(unique_ptr<UserStore> store) {
+    g_store = move(store);
+}
@@ -0,0 +1,36 @@
+#ifndef USERSTORE_H
+#define USERSTORE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+// 用户存储后端接口：登录/注册（HttpRequest::UserVerify）只通过它访问用户数据，不依赖具体数据库。
+//   - MySqlUserStore：MySQL（SqlConnPool + 预编译语句 + 注册组提交）
+//   - SqliteUserStore：嵌入式 SQLite 文件，不需要数据库服务
+//   - MemUserStore：进程内无锁哈希表，不落盘，用于压测认证路径本身的开销
+// 由 WebServer 按 ServerOptions::userStore 创建并通过 Set 安装；实现需可被多个线程并发调用。
+class UserStore {
+public:
+    enum RESULT {
+        FOUND,
+        NOT_FOUND,
+        ERROR,      // 后端出错（如数据库不可用）
+    };
+
+    virtual ~UserStore() = default;
+
+    // 查询用户密码
+    virtual RESULT Find(const std::string& name, std::string* pwd) = 0;
+    // 插入新用户；用户名已存在或出错返回 false
+    virtual bool Insert(const std::string& name, const std::string& pwd) = 0;
+    // 取出全部用户名（启动时建立用户名过滤器），不支持或出错返回 false
+    virtual bool LoadNames(std::vector<std::string>* names) = 0;
+    virtual const char* Name() const = 0;
+
+    // 当前安装的后端（未安装时为 nullptr）
+    static UserStore* Instance();
+    static void Set(std::unique_ptr<UserStore> store);
+};
+
+#endif //USERSTORE_H
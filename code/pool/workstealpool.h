@@ -0,0 +1,353 @@
+#ifndef WORKSTEALPOOL_H
+#define WORKSTEALPOOL_H
+
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <assert.h>
+#include <stdint.h>
+#include "mpmcqueue.h"
+
+// 工作窃取线程池
+//   - 每个工作线程有一个无锁本地双端队列（Chase-Lev）：自己从底部取，其他线程从顶部偷
+//   - 主线程（Reactor）提交的任务进入共享的提交队列，工作线程一次搬运一批到本地队列，减少抢锁次数
+//   - 工作线程自己提交的任务直接进本地队列
+//   - 空闲线程挂起在各自的条件变量上；提交任务时只在没有线程正在找活时唤醒一个，避免惊群
+//   - 连接亲和：AddTask(task, key) 把同一 key（连接）的任务优先投递到固定线程的信箱，
+//     同一连接的 Buffer / 请求状态留在同一个核的缓存里；该线程忙且信箱积压时由空闲线程窃取
+// 接口与 ThreadPool 相同：AddTask(F&&)
+class WorkStealPool {
+public:
+    explicit WorkStealPool(size_t threadCount = 8): pool_(std::make_shared<Pool>(threadCount)) {
+        assert(threadCount > 0);
+        for(size_t i = 0; i < threadCount; i++) {
+            std::thread([pool = pool_, i] { pool->Run(i); }).detach();
+        }
+    }
+
+    WorkStealPool() = default;
+
+    WorkStealPool(WorkStealPool&&) = default;
+
+    ~WorkStealPool() {
+        if(static_cast<bool>(pool_)) {
+            pool_->Close();
+        }
+    }
+
+    template<class F>
+    void AddTask(F&& task) {
+        pool_->Push(new Task(std::forward<F>(task)));
+    }
+
+    // 亲和提交：key 相同的任务优先由同一个工作线程执行
+    template<class F>
+    void AddTask(F&& task, size_t key) {
+        pool_->PushTo(key % pool_->workers.size(), new Task(std::forward<F>(task)));
+    }
+
+    size_t Threads() const { return pool_->workers.size(); }
+
+    // 排队任务数的近似值（提交队列 + 各线程本地队列和信箱），只用于统计
+    size_t QueueSize() const {
+        size_t n = pool_->injectSize.load(std::memory_order_relaxed);
+        for(auto& w : pool_->workers) {
+            n += w->deque.Size() + w->mailbox.Size();
+        }
+        return n;
+    }
+
+private:
+    typedef std::function<void()> Task;
+
+    // Chase-Lev 工作窃取队列（固定容量），内存序参考
+    // "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al., PPoPP'13)
+    // Push/Pop 只能由拥有者线程调用，Steal 可由任意线程调用
+    class WorkDeque {
+    public:
+        WorkDeque(): top_(0), bottom_(0) {
+            for(auto& slot : buf_) { slot.store(nullptr, std::memory_order_relaxed); }
+        }
+
+        // 队列已满返回 false
+        bool Push(Task* task) {
+            int64_t b = bottom_.load(std::memory_order_relaxed);
+            int64_t t = top_.load(std::memory_order_acquire);
+            if(b - t >= static_cast<int64_t>(CAPACITY)) { return false; }
+            buf_[b & MASK].store(task, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        Task* Pop() {
+            int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+            bottom_.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top_.load(std::memory_order_relaxed);
+            if(t > b) {
+                /* 队列为空 */
+                bottom_.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            Task* task = buf_[b & MASK].load(std::memory_order_relaxed);
+            if(t == b) {
+                /* 最后一个元素，与窃取者竞争 */
+                if(!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    task = nullptr;
+                }
+                bottom_.store(b + 1, std::memory_order_relaxed);
+            }
+            return task;
+        }
+
+        Task* Steal() {
+            int64_t t = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = bottom_.load(std::memory_order_acquire);
+            if(t >= b) { return nullptr; }
+            Task* task = buf_[t & MASK].load(std::memory_order_relaxed);
+            if(!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return nullptr;     // 被其他线程抢先，调用方换一个目标
+            }
+            return task;
+        }
+
+        bool Empty() const {
+            return bottom_.load(std::memory_order_seq_cst) <= top_.load(std::memory_order_seq_cst);
+        }
+
+        size_t Size() const {
+            int64_t n = bottom_.load(std::memory_order_relaxed) - top_.load(std::memory_order_relaxed);
+            return n > 0 ? static_cast<size_t>(n) : 0;
+        }
+
+        static const size_t CAPACITY = 1024;
+
+    private:
+        static const size_t MASK = CAPACITY - 1;
+        std::atomic<int64_t> top_;
+        std::atomic<int64_t> bottom_;
+        std::atomic<Task*> buf_[CAPACITY];
+    };
+
+    struct Worker {
+        WorkDeque deque;
+        MpmcQueue<Task*> mailbox{MAILBOX_SIZE};    // 亲和任务信箱：任意线程投递，主人优先取，其他线程可窃取
+        std::mutex mtx;
+        std::condition_variable cond;
+        bool notified = false;
+
+        static const size_t MAILBOX_SIZE = 256;
+    };
+
+    struct Pool {
+        explicit Pool(size_t threadCount): isClosed(false), searching(0), injectSize(0) {
+            for(size_t i = 0; i < threadCount; i++) {
+                workers.emplace_back(new Worker);
+            }
+        }
+
+        ~Pool() {
+            for(auto task : inject) { delete task; }
+            for(auto& w : workers) {
+                while(Task* task = w->deque.Pop()) { delete task; }
+                Task* task;
+                while(w->mailbox.TryPop(task)) { delete task; }
+            }
+        }
+
+        void Push(Task* task) {
+            /* 工作线程提交到自己的本地队列，满了再退回提交队列 */
+            if(Current() == this && workers[Index()]->deque.Push(task)) {
+                Notify();
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> locker(injectMtx);
+                inject.push_back(task);
+            }
+            injectSize.fetch_add(1);
+            Notify();
+        }
+
+        // 投递到 i 号线程的信箱；信箱满（该线程过载）时退回提交队列，由任意线程处理
+        void PushTo(size_t i, Task* task) {
+            Worker& w = *workers[i];
+            if(!w.mailbox.TryPush(task)) {
+                Push(task);
+                return;
+            }
+            /* 目标线程挂起则直接唤醒它；它正忙且信箱已有积压时，再唤醒别的线程来窃取 */
+            bool parked = false;
+            {
+                std::lock_guard<std::mutex> locker(idleMtx);
+                for(size_t k = 0; k < idle.size(); k++) {
+                    if(idle[k] == i) { idle.erase(idle.begin() + k); parked = true; break; }
+                }
+            }
+            if(parked) { Unpark(i); }
+            else if(w.mailbox.Size() > AFFINE_BACKLOG) { Notify(); }
+        }
+
+        // 唤醒一个挂起的线程；已有线程在找活时不唤醒，由它去取
+        void Notify() {
+            if(searching.load() > 0) { return; }
+            size_t i;
+            {
+                std::lock_guard<std::mutex> locker(idleMtx);
+                if(idle.empty()) { return; }
+                i = idle.back();
+                idle.pop_back();
+            }
+            Unpark(i);
+        }
+
+        void Unpark(size_t i) {
+            Worker& w = *workers[i];
+            {
+                std::lock_guard<std::mutex> locker(w.mtx);
+                w.notified = true;
+            }
+            w.cond.notify_one();
+        }
+
+        // 从提交队列搬运一批任务：返回第一个，其余放入本地队列
+        Task* PopInject(size_t i) {
+            if(injectSize.load() == 0) { return nullptr; }
+            Task* first = nullptr;
+            std::lock_guard<std::mutex> locker(injectMtx);
+            size_t n = std::min(inject.size(), std::max<size_t>(1, inject.size() / workers.size()));
+            if(n > BATCH) { n = BATCH; }
+            for(size_t k = 0; k < n; k++) {
+                Task* task = inject.front();
+                if(k > 0 && !workers[i]->deque.Push(task)) { break; }
+                inject.pop_front();
+                injectSize.fetch_sub(1);
+                if(k == 0) { first = task; }
+            }
+            return first;
+        }
+
+        // 从随机位置开始依次尝试偷其他线程的任务
+        Task* StealFrom(size_t i) {
+            size_t n = workers.size();
+            size_t start = NextRand() % n;
+            for(size_t k = 0; k < n; k++) {
+                size_t victim = (start + k) % n;
+                if(victim == i) { continue; }
+                if(Task* task = workers[victim]->deque.Steal()) { return task; }
+                Task* task;
+                if(workers[victim]->mailbox.TryPop(task)) { return task; }
+            }
+            return nullptr;
+        }
+
+        bool HasWork() {
+            if(injectSize.load() > 0) { return true; }
+            for(auto& w : workers) {
+                if(!w->deque.Empty() || !w->mailbox.Empty()) { return true; }
+            }
+            return false;
+        }
+
+        Task* FindTask(size_t i) {
+            if(Task* task = workers[i]->deque.Pop()) { return task; }
+            Task* mail;
+            if(workers[i]->mailbox.TryPop(mail)) { return mail; }
+            searching.fetch_add(1);
+            Task* task = PopInject(i);
+            if(!task) { task = StealFrom(i); }
+            searching.fetch_sub(1);
+            /* 从提交队列搬来一批或提交队列仍有积压时，接力唤醒下一个线程来偷 */
+            if(task && (injectSize.load() > 0 || !workers[i]->deque.Empty())) { Notify(); }
+            return task;
+        }
+
+        void Park(size_t i) {
+            {
+                std::lock_guard<std::mutex> locker(idleMtx);
+                idle.push_back(i);
+            }
+            /* 登记空闲后再检查一次，防止与 Push 交错而丢失唤醒 */
+            if(HasWork() || isClosed.load()) {
+                bool removed = false;
+                {
+                    std::lock_guard<std::mutex> locker(idleMtx);
+                    for(size_t k = 0; k < idle.size(); k++) {
+                        if(idle[k] == i) { idle.erase(idle.begin() + k); removed = true; break; }
+                    }
+                }
+                if(removed) { return; }
+                /* 已被 Notify 取走，唤醒信号马上会到，继续等待即可 */
+            }
+            Worker& w = *workers[i];
+            std::unique_lock<std::mutex> locker(w.mtx);
+            w.cond.wait(locker, [&]{ return w.notified || isClosed.load(); });
+            w.notified = false;
+        }
+
+        void Run(size_t i) {
+            Current() = this;
+            Index() = i;
+            while(true) {
+                if(Task* task = FindTask(i)) {
+                    (*task)();
+                    delete task;
+                    continue;
+                }
+                if(isClosed.load()) { break; }
+                Park(i);
+            }
+            Current() = nullptr;
+        }
+
+        void Close() {
+            isClosed = true;
+            for(size_t i = 0; i < workers.size(); i++) { Unpark(i); }
+        }
+
+        static uint32_t NextRand() {
+            static thread_local uint32_t seed = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed;
+        }
+
+        static const size_t BATCH = 32;
+        // 亲和线程忙时，信箱积压超过该值才唤醒其他线程窃取。取 0：主人忙时立即唤醒窃取者，
+        // 否则信箱里的任务要排在主人手上的慢任务之后（bench_threadpool 的 blocked 一栏：取 1 时 p50 约 2.7ms，取 0 时约 1.6us），
+        // 局部性只在主人空闲（被直接唤醒）或先于窃取者取到时保留，亲和因此只是尽力而为
+        static const size_t AFFINE_BACKLOG = 0;
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::atomic<bool> isClosed;
+        std::atomic<int> searching;         // 正在找活（取提交队列 / 窃取）的线程数
+
+        std::mutex injectMtx;
+        std::deque<Task*> inject;           // 提交队列
+        std::atomic<size_t> injectSize;
+
+        std::mutex idleMtx;
+        std::vector<size_t> idle;           // 挂起线程的下标（栈）
+
+        // 当前线程所属的池及其下标，用于把工作线程提交的任务放进本地队列
+        static Pool*& Current() {
+            static thread_local Pool* current = nullptr;
+            return current;
+        }
+        static size_t& Index() {
+            static thread_local size_t index = 0;
+            return index;
+        }
+    };
+    std::shared_ptr<Pool> pool_;
+};
+
+#endif //WORKSTEALPOOL_H
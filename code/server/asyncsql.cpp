@@ -0,0 +1,299 @@
+#include "asyncsql.h"
+using namespace std;
+
+AsyncSql::AsyncSql(CoScheduler* sched): port_(0), timeoutSec_(1), sched_(sched) {
+    assert(sched_);
+}
+
+AsyncSql::~AsyncSql() {
+    for(MYSQL* sql : conns_) {
+        sched_->Unregister(mysql_get_socket(sql));
+        mysql_close(sql);
+    }
+}
+
+bool AsyncSql::Init(const char* host, int port, const char* user, const char* pwd,
+                    const char* dbName, int connSize, int timeoutMs) {
+#ifdef MYSQL_WAIT_READ
+    assert(connSize > 0);
+    host_ = host;
+    user_ = user;
+    pwd_ = pwd;
+    dbName_ = dbName;
+    port_ = port;
+    /* 读写超时由库在需要时通过 MYSQL_WAIT_TIMEOUT 告知，秒为单位 */
+    timeoutSec_ = timeoutMs > 1000 ? timeoutMs / 1000 : 1;
+    for(int i = 0; i < connSize; i++) {
+        MYSQL* sql = NewConn_();
+        if(!sql) { break; }
+        if(!mysql_real_connect(sql, host, user, pwd, dbName, port, nullptr, 0) || mysql_get_socket(sql) < 0) {
+            LOG_ERROR("AsyncSql connect error: %s", mysql_error(sql));
+            mysql_close(sql);
+            break;
+        }
+        sched_->Register(mysql_get_socket(sql));
+        conns_.push_back(sql);
+        free_.push_back(sql);
+    }
+    return !conns_.empty();
+#else
+    (void)host; (void)port; (void)user; (void)pwd; (void)dbName; (void)connSize; (void)timeoutMs;
+    LOG_WARN("AsyncSql: MySQL client library has no non-blocking API");
+    return false;
+#endif
+}
+
+MYSQL* AsyncSql::NewConn_() {
+    MYSQL* sql = mysql_init(nullptr);
+    if(!sql) {
+        LOG_ERROR("AsyncSql init error!");
+        return nullptr;
+    }
+#ifdef MYSQL_WAIT_READ
+    mysql_options(sql, MYSQL_OPT_NONBLOCK, 0);
+#endif
+    mysql_options(sql, MYSQL_OPT_CONNECT_TIMEOUT, &timeoutSec_);
+    mysql_options(sql, MYSQL_OPT_READ_TIMEOUT, &timeoutSec_);
+    mysql_options(sql, MYSQL_OPT_WRITE_TIMEOUT, &timeoutSec_);
+    return sql;
+}
+
+bool AsyncSql::AcquireAwaiter::await_ready() {
+    if(db_->conns_.empty()) { return true; }     // 全部断开：不等待，sql_ 为 nullptr
+    if(db_->free_.empty()) { return false; }
+    sql_ = db_->free_.back();
+    db_->free_.pop_back();
+    return true;
+}
+
+void AsyncSql::AcquireAwaiter::await_suspend(std::coroutine_handle<> h) {
+    handle_ = h;
+    db_->waiting_.push_back(this);
+}
+
+void AsyncSql::Release(MYSQL* sql, bool broken) {
+    assert(sql);
+    /* 2000 起是客户端错误（CR_SERVER_GONE_ERROR、CR_SERVER_LOST 等）：连接已不可用 */
+    if(broken || mysql_errno(sql) >= 2000) {
+        Reconnect_(sql);
+        return;
+    }
+    if(waiting_.empty()) {
+        free_.push_back(sql);
+        return;
+    }
+    /* 直接交给等待最久的协程；推迟到 RunReady 恢复，避免在归还者的调用栈里嵌套执行 */
+    AcquireAwaiter* waiter = waiting_.front();
+    waiting_.pop_front();
+    waiter->sql_ = sql;
+    std::coroutine_handle<> h = waiter->handle_;
+    sched_->Post([h] { h.resume(); });
+}
+
+CoHandler AsyncSql::Reconnect_(MYSQL* broken) {
+    LOG_WARN("AsyncSql: connection broken (%s), reconnecting", mysql_error(broken));
+    for(size_t i = 0; i < conns_.size(); i++) {
+        if(conns_[i] == broken) {
+            conns_.erase(conns_.begin() + i);
+            break;
+        }
+    }
+    sched_->Unregister(mysql_get_socket(broken));
+    mysql_close(broken);
+    /* 已没有可用连接：等待中的协程不再等重连，拿 nullptr 立即返回 */
+    if(conns_.empty()) {
+        while(!waiting_.empty()) {
+            std::coroutine_handle<> h = waiting_.front()->handle_;
+            waiting_.pop_front();
+            sched_->Post([h] { h.resume(); });
+        }
+    }
+    for(int delayMs = RECONNECT_MIN_MS; ; delayMs = delayMs * 2 < RECONNECT_MAX_MS ? delayMs * 2 : RECONNECT_MAX_MS) {
+        MYSQL* sql = NewConn_();
+        if(sql) {
+            if(co_await ConnectAwaiter(this, sql)) {
+                LOG_INFO("AsyncSql: reconnected, %zu conns", conns_.size() + 1);
+                conns_.push_back(sql);
+                Release(sql);
+                co_return;
+            }
+            LOG_WARN("AsyncSql reconnect error: %s, retry in %dms", mysql_error(sql), delayMs);
+            mysql_close(sql);
+        }
+        co_await sched_->Sleep(delayMs);
+    }
+}
+
+#ifdef MYSQL_WAIT_READ
+void AsyncSql::Wait_(CoScheduler::FdWaiter* waiter, MYSQL* sql, int fd, int status) {
+    uint32_t events = 0;
+    if(status & MYSQL_WAIT_READ) { events |= EPOLLIN; }
+    if(status & MYSQL_WAIT_WRITE) { events |= EPOLLOUT; }
+    if(status & MYSQL_WAIT_EXCEPT) { events |= EPOLLPRI; }
+    int timeoutMs = (status & MYSQL_WAIT_TIMEOUT) ? mysql_get_timeout_value(sql) * 1000 : 0;
+    sched_->WaitFd(waiter, fd, events, timeoutMs);
+}
+
+int AsyncSql::ReadyStatus_(bool ok, uint32_t events) {
+    if(!ok) { return MYSQL_WAIT_TIMEOUT; }
+    int ready = 0;
+    if(events & EPOLLIN) { ready |= MYSQL_WAIT_READ; }
+    if(events & EPOLLOUT) { ready |= MYSQL_WAIT_WRITE; }
+    if(events & EPOLLPRI) { ready |= MYSQL_WAIT_EXCEPT; }
+    /* 出错/挂断：让库去读写，由它报告错误 */
+    if(events & (EPOLLERR | EPOLLHUP)) { ready |= MYSQL_WAIT_READ | MYSQL_WAIT_WRITE; }
+    return ready;
+}
+
+bool AsyncSql::ConnectAwaiter::await_suspend(std::coroutine_handle<> h) {
+    handle_ = h;
+    return Step_(mysql_real_connect_start(&ret_, sql_, db_->host_.c_str(), db_->user_.c_str(), db_->pwd_.c_str(),
+                                          db_->dbName_.c_str(), db_->port_, nullptr, 0));
+}
+
+bool AsyncSql::ConnectAwaiter::Step_(int status) {
+    if(status) {
+        /* 连接过程中 socket 才创建出来，第一次等待前注册到 epoll */
+        if(sock_ < 0) {
+            sock_ = mysql_get_socket(sql_);
+            db_->sched_->Register(sock_);
+        }
+        db_->Wait_(this, sql_, sock_, status);
+        return true;
+    }
+    if(!ret_ && sock_ >= 0) {
+        db_->sched_->Unregister(sock_);
+        sock_ = -1;
+    }
+    return false;
+}
+
+void AsyncSql::ConnectAwaiter::Ready(bool ok, uint32_t events) {
+    if(!Step_(mysql_real_connect_cont(&ret_, sql_, ReadyStatus_(ok, events)))) {
+        handle_.resume();
+    }
+}
+
+bool AsyncSql::QueryAwaiter::await_suspend(std::coroutine_handle<> h) {
+    handle_ = h;
+    return Step_(mysql_real_query_start(&err_, sql_, stmt_.data(), stmt_.size()));
+}
+
+bool AsyncSql::QueryAwaiter::Step_(int status) {
+    while(true) {
+        if(status) {
+            db_->Wait_(this, sql_, mysql_get_socket(sql_), status);
+            return true;
+        }
+        /* 当前阶段完成：查询成功则开始取结果集 */
+        if(phase_ == QUERY && !err_) {
+            phase_ = STORE;
+            status = mysql_store_result_start(&res_, sql_);
+            continue;
+        }
+        return false;
+    }
+}
+
+void AsyncSql::QueryAwaiter::Ready(bool ok, uint32_t events) {
+    int ready = ReadyStatus_(ok, events);
+    int status = (phase_ == QUERY) ? mysql_real_query_cont(&err_, sql_, ready)
+                                   : mysql_store_result_cont(&res_, sql_, ready);
+    if(!Step_(status)) {
+        handle_.resume();
+    }
+}
+#else
+void AsyncSql::Wait_(CoScheduler::FdWaiter*, MYSQL*, int, int) {}
+
+int AsyncSql::ReadyStatus_(bool, uint32_t) {
+    return 0;
+}
+
+bool AsyncSql::ConnectAwaiter::await_suspend(std::coroutine_handle<>) {
+    return false;
+}
+
+bool AsyncSql::ConnectAwaiter::Step_(int) {
+    return false;
+}
+
+void AsyncSql::ConnectAwaiter::Ready(bool, uint32_t) {
+    handle_.resume();
+}
+
+bool AsyncSql::QueryAwaiter::await_suspend(std::coroutine_handle<>) {
+    err_ = -1;
+    return false;
+}
+
+bool AsyncSql::QueryAwaiter::Step_(int) {
+    return false;
+}
+
+void AsyncSql::QueryAwaiter::Ready(bool, uint32_t) {
+    handle_.resume();
+}
+#endif
+
+AsyncSql::Result AsyncSql::QueryAwaiter::await_resume() const noexcept {
+    Result result;
+    result.res = res_;
+    result.ok = phase_ == STORE && !err_ && (res_ || mysql_errno(sql_) == 0);
+    if(!result.ok) {
+        LOG_ERROR("AsyncSql query error: %s", mysql_error(sql_));
+    }
+    return result;
+}
+
+string AsyncSql::Escape(MYSQL* sql, const string& str) {
+    string out(str.size() * 2 + 1, '\0');
+    unsigned long len = mysql_real_escape_string(sql, &out[0], str.data(), str.size());
+    out.resize(len);
+    return out;
+}
+
+CoTask<bool> AsyncSql::UserVerify(string name, string pwd, bool isLogin) {
+    if(name == "" || pwd == "") { co_return false; }
+    LOG_INFO("Verify(async) name:%s", name.c_str());
+    /* 缓存命中或过滤器确定用户名不存在时不查数据库（同 HttpRequest::UserVerify） */
+    UserCache* cache = UserCache::Instance();
+    bool match;
+    if(cache->Get(name, pwd, &match)) { co_return isLogin && match; }
+    bool known = cache->MayExist(name);
+    if(!known) {
+        cache->Filtered();
+        if(isLogin) { co_return false; }
+    }
+    MYSQL* sql = co_await Acquire();
+    if(!sql) { co_return false; }   // 所有非阻塞连接都已断开，正在重连
+
+    bool flag = !isLogin;   // 注册场景：先假设用户名可用
+    Result r;
+    if(known) {
+        r = co_await Query(sql, "SELECT username,password FROM user WHERE username='"
+                                + Escape(sql, name) + "' LIMIT 1");
+        if(!r.ok || !r.res) {
+            if(r.res) { mysql_free_result(r.res); }
+            Release(sql);
+            co_return false;
+        }
+        while(MYSQL_ROW row = mysql_fetch_row(r.res)) {
+            /* 登录：密码匹配才成功；注册：用户名已存在则失败 */
+            if(row[1]) { cache->Put(name, row[1]); }
+            flag = isLogin && row[1] && pwd == row[1];
+        }
+        mysql_free_result(r.res);
+    }
+
+    if(!isLogin && flag) {
+        LOG_DEBUG("register!");
+        r = co_await Query(sql, "INSERT INTO user(username, password) VALUES('"
+                                + Escape(sql, name) + "','" + Escape(sql, pwd) + "')");
+        if(r.res) { mysql_free_result(r.res); }
+        flag = r.ok;
+        if(flag) { cache->Put(name, pwd); }
+    }
+    Release(sql);
+    co_return flag;
+}
@@ -0,0 +1,123 @@
+#ifndef ASYNC_SQL_H
+#define ASYNC_SQL_H
+
+#include <mysql/mysql.h>
+#include <string>
+#include <vector>
+#include <deque>
+
+#include "coscheduler.h"
+#include "../log/log.h"
+#include "../pool/usercache.h"
+
+// 非阻塞 MySQL 客户端（MariaDB Connector/C 的 *_start / *_cont 接口）。
+// 连接的 socket 注册在 Reactor 的 epoll 中，查询在等待数据库期间挂起协程，
+// 数据到达后由事件循环驱动状态机继续；一个 Reactor 线程可以同时挂着任意多个查询。
+// 只在 Reactor 线程使用，内部不加锁。客户端库没有非阻塞接口时 Init 返回 false。
+// 查询时连接断开（客户端错误 CR_*）的连接不再放回空闲列表：关闭后在后台非阻塞重连，
+// 重连期间 Size() 变小，全部断开时调用方应退回阻塞通道。
+class AsyncSql {
+public:
+    struct Result {
+        bool ok;            // 语句执行成功
+        MYSQL_RES* res;     // 结果集（无结果集的语句为 nullptr），由调用方 mysql_free_result
+    };
+
+    explicit AsyncSql(CoScheduler* sched);
+    ~AsyncSql();
+
+    AsyncSql(const AsyncSql&) = delete;
+    AsyncSql& operator=(const AsyncSql&) = delete;
+
+    // 建立 connSize 个非阻塞连接（启动时调用，阻塞）
+    bool Init(const char* host, int port, const char* user, const char* pwd,
+              const char* dbName, int connSize, int timeoutMs = 3000);
+    // 当前可用（未断开）的连接数
+    size_t Size() const { return conns_.size(); }
+
+    // 取一个空闲连接；没有空闲连接时挂起，直到有连接归还；所有连接都已断开时得到 nullptr
+    class AcquireAwaiter {
+    public:
+        explicit AcquireAwaiter(AsyncSql* db): db_(db), sql_(nullptr) {}
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> h);
+        MYSQL* await_resume() const noexcept { return sql_; }
+    private:
+        friend class AsyncSql;
+        AsyncSql* db_;
+        MYSQL* sql_;
+        std::coroutine_handle<> handle_;
+    };
+    AcquireAwaiter Acquire() { return AcquireAwaiter(this); }
+    // 归还连接；broken 为 true（或连接上有客户端错误）时关闭并在后台重连
+    void Release(MYSQL* sql, bool broken = false);
+
+    // 执行一条语句并取回结果集：real_query -> store_result 两个阶段，每个阶段按库的要求等待 socket
+    class QueryAwaiter: public CoScheduler::FdWaiter {
+    public:
+        QueryAwaiter(AsyncSql* db, MYSQL* sql, std::string stmt)
+            : db_(db), sql_(sql), stmt_(std::move(stmt)), phase_(QUERY), err_(0), res_(nullptr) {}
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h);
+        Result await_resume() const noexcept;
+        void Ready(bool ok, uint32_t events) override;
+    private:
+        enum PHASE { QUERY, STORE };
+        // 处理库返回的等待状态：需要等待返回 true（已挂到 epoll），完成返回 false
+        bool Step_(int status);
+        AsyncSql* db_;
+        MYSQL* sql_;
+        std::string stmt_;
+        PHASE phase_;
+        int err_;
+        MYSQL_RES* res_;
+        std::coroutine_handle<> handle_;
+    };
+    QueryAwaiter Query(MYSQL* sql, std::string stmt) { return QueryAwaiter(this, sql, std::move(stmt)); }
+
+    // 与 HttpRequest::UserVerify 相同的登录/注册逻辑，查询期间不占用线程
+    CoTask<bool> UserVerify(std::string name, std::string pwd, bool isLogin);
+
+    // 转义字符串用于拼接 SQL
+    static std::string Escape(MYSQL* sql, const std::string& str);
+
+private:
+    // 非阻塞建立连接：real_connect_start/cont，socket 在第一次等待时注册，连接失败时注销
+    class ConnectAwaiter: public CoScheduler::FdWaiter {
+    public:
+        ConnectAwaiter(AsyncSql* db, MYSQL* sql): db_(db), sql_(sql), ret_(nullptr), sock_(-1) {}
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h);
+        bool await_resume() const noexcept { return ret_ != nullptr; }
+        void Ready(bool ok, uint32_t events) override;
+    private:
+        bool Step_(int status);
+        AsyncSql* db_;
+        MYSQL* sql_;
+        MYSQL* ret_;
+        int sock_;
+        std::coroutine_handle<> handle_;
+    };
+
+    // 按 Init 的参数创建一个未连接的句柄（非阻塞、超时选项）
+    MYSQL* NewConn_();
+    // 关闭断开的连接并在后台重连，失败后退避重试
+    CoHandler Reconnect_(MYSQL* broken);
+    // 库返回的等待状态 -> 挂到 epoll 上等待；epoll 结果 -> 传给库的就绪状态
+    void Wait_(CoScheduler::FdWaiter* waiter, MYSQL* sql, int fd, int status);
+    static int ReadyStatus_(bool ok, uint32_t events);
+
+    static const int RECONNECT_MIN_MS = 500;
+    static const int RECONNECT_MAX_MS = 30000;
+
+    std::string host_, user_, pwd_, dbName_;
+    int port_;
+    unsigned int timeoutSec_;
+
+    CoScheduler* sched_;
+    std::vector<MYSQL*> conns_;
+    std::vector<MYSQL*> free_;
+    std::deque<AcquireAwaiter*> waiting_;   // 等待空闲连接的协程（先来先得）
+};
+
+#endif //ASYNC_SQL_H
@@ -0,0 +1,128 @@
+#include "coscheduler.h"
+
+CoScheduler::CoScheduler(Epoller* epoller): epoller_(epoller), waiterCount_(0), registeredCount_(0), waitSeq_(0), timerId_(0) {
+    assert(epoller_);
+    eventFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    assert(eventFd_ >= 0);
+    epoller_->AddFd(eventFd_, EPOLLIN);
+}
+
+CoScheduler::~CoScheduler() {
+    epoller_->DelFd(eventFd_);
+    close(eventFd_);
+}
+
+void CoScheduler::Post(Task task) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> locker(readyMtx_);
+        wake = ready_.empty();
+        ready_.push_back(std::move(task));
+    }
+    /* 队列从空变为非空时才写 eventfd，Reactor 醒来后一次执行全部 */
+    if(wake) {
+        uint64_t one = 1;
+        ssize_t ret = write(eventFd_, &one, sizeof(one));
+        (void)ret;
+    }
+}
+
+void CoScheduler::RunReady() {
+    /* 先清 eventfd 再取任务：取走之后的 Post 会看到空队列并重新写 eventfd，不会丢唤醒 */
+    uint64_t cnt;
+    ssize_t ret = read(eventFd_, &cnt, sizeof(cnt));
+    (void)ret;
+    {
+        std::lock_guard<std::mutex> locker(readyMtx_);
+        ready_.swap(running_);
+    }
+    for(auto& task : running_) {
+        task();
+    }
+    running_.clear();
+}
+
+void CoScheduler::Register(int fd) {
+    {
+        std::lock_guard<std::mutex> locker(waitMtx_);
+        registered_.insert(fd);
+    }
+    registeredCount_++;
+    epoller_->AddFd(fd, EPOLLONESHOT);
+}
+
+void CoScheduler::Unregister(int fd) {
+    Take_(fd);
+    {
+        std::lock_guard<std::mutex> locker(waitMtx_);
+        if(!registered_.erase(fd)) { return; }
+    }
+    registeredCount_--;
+    epoller_->DelFd(fd);
+}
+
+void CoScheduler::WaitFd(FdWaiter* waiter, int fd, uint32_t events, int timeoutMs) {
+    assert(waiter);
+    waiter->fd_ = fd;
+    waiter->events_ = events;
+    {
+        std::lock_guard<std::mutex> locker(waitMtx_);
+        assert(waiters_.count(fd) == 0);
+        waiter->seq_ = ++waitSeq_;
+        waiters_[fd] = waiter;
+    }
+    waiterCount_++;
+    if(timeoutMs > 0) {
+        uint64_t seq = waiter->seq_;
+        timer_.add(++timerId_, timeoutMs, [this, fd, seq] {
+            Post([this, fd, seq] {
+                /* 事件先到时等待者已被取走（或已换成新的等待），超时作废 */
+                if(FdWaiter* w = Take_(fd, seq)) { w->Ready(false, 0); }
+            });
+        });
+    }
+    epoller_->ModFd(fd, events | EPOLLONESHOT);
+}
+
+CoScheduler::FdWaiter* CoScheduler::Take_(int fd, uint64_t seq) {
+    if(waiterCount_.load() == 0) { return nullptr; }
+    FdWaiter* waiter = nullptr;
+    {
+        std::lock_guard<std::mutex> locker(waitMtx_);
+        auto it = waiters_.find(fd);
+        if(it == waiters_.end() || (seq && it->second->seq_ != seq)) { return nullptr; }
+        waiter = it->second;
+        waiters_.erase(it);
+    }
+    waiterCount_--;
+    return waiter;
+}
+
+bool CoScheduler::OnEvent(int fd, uint32_t events) {
+    FdWaiter* waiter = Take_(fd);
+    if(!waiter) {
+        /* 超时后迟到的事件、空闲时的挂断：不是连接的 fd，不交给 WebServer */
+        if(registeredCount_.load() == 0) { return false; }
+        std::lock_guard<std::mutex> locker(waitMtx_);
+        return registered_.count(fd) > 0;
+    }
+    /* 出错/挂断也照常回调，由等待者的下一次读写发现错误 */
+    waiter->Ready(true, events);
+    return true;
+}
+
+void CoScheduler::Cancel(int fd) {
+    FdWaiter* waiter = Take_(fd);
+    if(!waiter) { return; }
+    /* 可能在关闭连接的调用栈里，推迟到 RunReady 再恢复 */
+    Post([waiter] { waiter->Ready(false, 0); });
+}
+
+void CoScheduler::Sleep_(int ms, std::coroutine_handle<> h) {
+    /* 定时器回调在 HeapTimer::tick 中执行，不能直接恢复（协程可能再次 add），交给 RunReady */
+    timer_.add(++timerId_, ms, [this, h] { Post([h] { h.resume(); }); });
+}
+
+int CoScheduler::GetNextTick() {
+    return timer_.GetNextTick();
+}
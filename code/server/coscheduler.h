@@ -0,0 +1,211 @@
+#ifndef CO_SCHEDULER_H
+#define CO_SCHEDULER_H
+
+#include <coroutine>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <sys/eventfd.h>
+
+#include "epoller.h"
+#include "../log/log.h"
+#include "../timer/heaptimer.h"
+#include "../pool/task.h"
+#include "../pool/threadpool.h"
+#include "../pool/lanestats.h"
+
+// 协程处理函数的返回类型：启动即执行，结束自动销毁（fire-and-forget）。
+// 写法：CoHandler Foo(...) { ... co_await sched.Writable(fd, ev); ... }
+class CoHandler {
+public:
+    struct promise_type {
+        CoHandler get_return_object() noexcept { return CoHandler(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {
+            LOG_ERROR("Coroutine handler exception!");
+        }
+    };
+};
+
+// 可等待的协程任务：co_await 时才开始执行，结束后直接切回等待它的协程。
+// 用于把协程拆成子过程，如 bool ok = co_await asyncSql->UserVerify(...)；T 需可默认构造。
+template<class T>
+class CoTask {
+public:
+    struct promise_type {
+        T value{};
+        std::coroutine_handle<> cont;
+
+        CoTask get_return_object() noexcept {
+            return CoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                return h.promise().cont ? h.promise().cont : std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_value(T v) { value = std::move(v); }
+        void unhandled_exception() noexcept {
+            LOG_ERROR("Coroutine task exception!");
+        }
+    };
+
+    CoTask(CoTask&& other) noexcept: handle_(other.handle_) { other.handle_ = nullptr; }
+    CoTask(const CoTask&) = delete;
+    CoTask& operator=(const CoTask&) = delete;
+    ~CoTask() { if(handle_) { handle_.destroy(); } }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> cont) noexcept {
+        handle_.promise().cont = cont;
+        return handle_;
+    }
+    T await_resume() { return std::move(handle_.promise().value); }
+
+private:
+    explicit CoTask(std::coroutine_handle<promise_type> h): handle_(h) {}
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// 协程调度器：所有协程都在 Reactor（事件循环）线程上运行和恢复。
+//   - Readable / Writable：挂起直到 fd 可读/可写（事件由 WebServer::Start 交给 OnEvent）
+//   - Sleep：挂起指定毫秒（独立的 HeapTimer，到期后在 Reactor 线程恢复）
+//   - Run：把阻塞操作（如数据库查询）交给线程池执行，完成后回到 Reactor 线程恢复
+//   - WaitFd：底层接口，FdWaiter 在 fd 就绪或超时后收到回调（如驱动非阻塞 MySQL 状态机）
+// Post 可以从任意线程调用，通过 eventfd 唤醒 epoll_wait；其余接口只在 Reactor 线程调用。
+class CoScheduler {
+public:
+    CoScheduler(Epoller* epoller);
+    ~CoScheduler();
+
+    CoScheduler(const CoScheduler&) = delete;
+    CoScheduler& operator=(const CoScheduler&) = delete;
+
+    // 任意线程：把 task 交给 Reactor 线程执行
+    void Post(Task task);
+    // 执行所有已投递的任务（Reactor 线程在 eventfd 可读时调用）
+    void RunReady();
+    // fd 上有协程在等待时消费该事件并恢复协程，返回 true；否则返回 false，由 WebServer 按原流程处理
+    bool OnEvent(int fd, uint32_t events);
+    // 连接关闭时调用（任意线程）：等待该 fd 的协程以失败结果恢复
+    void Cancel(int fd);
+    // 距最近一个协程定时器到期的毫秒数，没有返回 -1（会先执行已到期的定时器）
+    int GetNextTick();
+
+    int EventFd() const { return eventFd_; }
+
+    // 等待 fd 就绪的对象：Ready(ok, events)，ok 为 false 表示超时或连接被关闭
+    class FdWaiter {
+    public:
+        virtual ~FdWaiter() = default;
+        virtual void Ready(bool ok, uint32_t events) = 0;
+    protected:
+        friend class CoScheduler;
+        int fd_ = -1;
+        uint32_t events_ = 0;
+        uint64_t seq_ = 0;      // 区分同一 fd 上先后的等待，过期的超时回调据此忽略
+    };
+
+    // 把 fd 注册到 epoll（不监听任何事件），之后用 WaitFd 按需等待；用于非连接的 fd（如 MySQL socket）
+    void Register(int fd);
+    void Unregister(int fd);
+    // 等待 fd 上的 events（EPOLLONESHOT 重新挂上）；timeoutMs > 0 时超时以 Ready(false, 0) 回调
+    void WaitFd(FdWaiter* waiter, int fd, uint32_t events, int timeoutMs = 0);
+
+    class FdAwaiter: public FdWaiter {
+    public:
+        FdAwaiter(CoScheduler* sched, int fd, uint32_t events): sched_(sched), ok_(false) {
+            fd_ = fd;
+            events_ = events;
+        }
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { handle_ = h; sched_->WaitFd(this, fd_, events_); }
+        // false 表示连接已被关闭（Cancel），协程不应再访问该连接
+        bool await_resume() const noexcept { return ok_; }
+        void Ready(bool ok, uint32_t) override { ok_ = ok; handle_.resume(); }
+    private:
+        CoScheduler* sched_;
+        bool ok_;
+        std::coroutine_handle<> handle_;
+    };
+
+    class SleepAwaiter {
+    public:
+        SleepAwaiter(CoScheduler* sched, int ms): sched_(sched), ms_(ms) {}
+        bool await_ready() const noexcept { return ms_ <= 0; }
+        void await_suspend(std::coroutine_handle<> h) { sched_->Sleep_(ms_, h); }
+        void await_resume() const noexcept {}
+    private:
+        CoScheduler* sched_;
+        int ms_;
+    };
+
+    // fn 在线程池中执行；线程池队列已满时不挂起，结果为空（false / nullopt）
+    template<class F>
+    class RunAwaiter {
+        using R = std::invoke_result_t<F&>;
+        using Result = std::conditional_t<std::is_void_v<R>, bool, std::optional<R>>;
+    public:
+        RunAwaiter(CoScheduler* sched, ThreadPool* pool, LaneStats* stats, F fn)
+            : sched_(sched), pool_(pool), stats_(stats), fn_(std::move(fn)), result_() {}
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h) {
+            auto job = [this, h] {
+                if constexpr (std::is_void_v<R>) { fn_(); result_ = true; }
+                else { result_.emplace(fn_()); }
+                sched_->Post([h] { h.resume(); });
+            };
+            return stats_ ? pool_->TryAdd(stats_->Wrap(job)) : pool_->TryAdd(job);
+        }
+        Result await_resume() { return std::move(result_); }
+    private:
+        CoScheduler* sched_;
+        ThreadPool* pool_;
+        LaneStats* stats_;
+        F fn_;
+        Result result_;
+    };
+
+    FdAwaiter Readable(int fd, uint32_t connEvent) { return FdAwaiter(this, fd, connEvent | EPOLLIN); }
+    FdAwaiter Writable(int fd, uint32_t connEvent) { return FdAwaiter(this, fd, connEvent | EPOLLOUT); }
+    SleepAwaiter Sleep(int ms) { return SleepAwaiter(this, ms); }
+    template<class F>
+    RunAwaiter<std::decay_t<F>> Run(ThreadPool& pool, F&& fn, LaneStats* stats = nullptr) {
+        return RunAwaiter<std::decay_t<F>>(this, &pool, stats, std::forward<F>(fn));
+    }
+
+private:
+    void Sleep_(int ms, std::coroutine_handle<> h);
+    // 从等待表中取出 fd 的等待者（seq 非 0 时必须匹配）
+    FdWaiter* Take_(int fd, uint64_t seq = 0);
+
+    Epoller* epoller_;
+    int eventFd_;
+
+    std::mutex readyMtx_;
+    std::vector<Task> ready_;           // 待在 Reactor 线程执行的任务
+    std::vector<Task> running_;         // RunReady 交换出来执行，避免持锁执行
+
+    std::mutex waitMtx_;
+    std::unordered_map<int, FdWaiter*> waiters_;    // fd -> 等待该 fd 的协程
+    std::atomic<int> waiterCount_;                  // 没有等待者时 OnEvent 不加锁
+    std::unordered_set<int> registered_;            // Register 的 fd：无人等待时的事件（如挂断）直接丢弃
+    std::atomic<int> registeredCount_;
+    uint64_t waitSeq_;
+
+    HeapTimer timer_;
+    int timerId_;
+};
+
+#endif //CO_SCHEDULER_H
@@ -2,21 +2,77 @@
 
 using namespace std;
 
+std::atomic<bool> WebServer::reload_(false);
+
 WebServer::WebServer(
     int port, int trigmODE, int timeoutMs, bool OptLinger,
     int sqlPort, const char* sqlUser, const char* sqlPwd,
     const char* dbName, int connPoolNum, int threadNum,
-    bool openLog, int logLevel, int logQueSize
-): port_(port), openLinger_(OptLinger), timeoutMS_(timeoutMs), isClose_(false), 
-timer_(new HeapTimer()), threadpool_(new ThreadPool(threadNum)), epoller_(new Epoller())
+    bool openLog, int logLevel, int logQueSize,
+    const ServerOptions& options
+): port_(port), openLinger_(OptLinger), timeoutMS_(timeoutMs), isClose_(false), affinity_(options.workSteal && options.affinity),
+coroutine_(options.coroutine && options.dbThreads > 0),
+timer_(new HeapTimer()), cpuStats_("cpu"), dbStats_("db"),
+codel_(options.shed ? new CoDel(options.shedTargetUs, options.shedIntervalUs) : nullptr),
+deadlineUs_(options.deadlineMs * 1000LL), expired_(0), statsInterval_(options.statsInterval),
+lastStats_(time(nullptr)), lastSessionTick_(lastStats_), epoller_(new Epoller())
 {
+    if(options.workSteal) { stealpool_.reset(new WorkStealPool(threadNum)); }
+    else {
+        ThreadPool::Elastic elastic;
+        if(options.elastic) {
+            elastic.minThreads = options.minThreads;
+            elastic.maxThreads = options.maxThreads;
+            elastic.targetWaitUs = options.targetWaitUs;
+            elastic.idleMs = options.idleMs;
+            elastic.report = [](size_t threads, const char* decision, int64_t waitUs) {
+                LOG_INFO("ThreadPool %s to %zu threads (queue wait %ldus)", decision, threads, (long)waitUs);
+            };
+        }
+        threadpool_.reset(new ThreadPool(threadNum, options.taskQueueSize, elastic));
+    }
+    if(options.dbThreads > 0) { dbpool_.reset(new ThreadPool(options.dbThreads, options.dbQueueSize)); }
+    if(coroutine_ || options.diskThreads > 0) { scheduler_.reset(new CoScheduler(epoller_.get())); }
     srcDir_ = getcwd(nullptr, 256); // 获取当前工作目录的绝对路径, 当第一个参数传 nullptr 时，getcwd 函数内部会调用 malloc 在堆上分配内存来存储路径字符串。
     assert(srcDir_);
     strncat(srcDir_, "../resources/", 16);// 拼接上资源文件夹名
     HttpConn::userCount = 0;    // 计数器归零
     HttpConn::srcDir = srcDir_; // 将路径共享给所有的 HttpConn 对象
-    // 初始化数据库连接池 (单例模式)
-    SqlConnPool::Instance()->Init("localhost", sqlPort, sqlUser, sqlPwd, dbName, connPoolNum);
+    HttpResponse::UpdateDate(); // 第一次事件循环之前先准备好 Date 头
+    // 用户存储后端：只有 mysql 后端才初始化数据库连接池、注册组提交和非阻塞连接
+    bool useMysql = options.userStore == "mysql";
+    if(useMysql){
+        // 初始化数据库连接池 (单例模式)
+        SqlConnPool::Options sqlOptions;
+        sqlOptions.minConn = options.sqlMinConns;
+        sqlOptions.acquireMs = options.sqlAcquireMs;
+        sqlOptions.ioTimeoutSec = options.sqlTimeoutSec;
+        sqlOptions.pingSec = options.sqlPingSec;
+        sqlOptions.idleSec = options.sqlIdleSec;
+        SqlConnPool::Instance()->Init("localhost", sqlPort, sqlUser, sqlPwd, dbName, connPoolNum, sqlOptions);
+        // 每个阻塞通道线程同时只提交一个注册，一批合并不到更多：上限取两者较小值，0 表示直接取线程数
+        size_t laneThreads = options.dbThreads > 0 ? options.dbThreads : threadNum;
+        size_t batch = options.registerBatch == 0 ? laneThreads : std::min(options.registerBatch, laneThreads);
+        GroupCommit::Instance()->Init(batch, options.registerWindowUs);
+        UserStore::Set(unique_ptr<UserStore>(new MySqlUserStore()));
+    }else if(options.userStore == "sqlite"){
+        unique_ptr<SqliteUserStore> store(new SqliteUserStore());
+        if(store->Open(options.sqliteFile)) { UserStore::Set(move(store)); }
+    }else if(options.userStore == "memory"){
+        UserStore::Set(unique_ptr<UserStore>(new MemUserStore(options.memoryUsers)));
+    }
+    UserCache::Instance()->Init(options.userCacheSize, options.userCacheTtl);
+    SessionStore::Instance()->Init(options.sessionTtl);
+    if(options.userFilter){
+        UserCache::Instance()->LoadFilter(UserStore::Instance());
+    }
+    // 非阻塞 MySQL 连接：客户端库不支持或连接失败时退回阻塞通道
+    if(useMysql && coroutine_ && options.asyncSqlConns > 0){
+        asyncSql_.reset(new AsyncSql(scheduler_.get()));
+        if(!asyncSql_->Init("localhost", sqlPort, sqlUser, sqlPwd, dbName, options.asyncSqlConns)){
+            asyncSql_.reset();
+        }
+    }
 
     // 设置 ET (边缘触发) 还是 LT (水平触发)
     InitEventMode_(trigmODE);
@@ -25,18 +81,64 @@ timer_(new HeapTimer()), threadpool_(new ThreadPool(threadNum)), epoller_(new Ep
 
     if(openLog){
         // 初始化日志单例：设置级别、路径、后缀、队列大小
-        Log::Instance()->init(logLevel, "./log", ".log", logQueSize);
+        Log::Instance()->SetFlushPolicy(options.logFlushMs, options.logFlushKB * 1024);
+        bool fullOk = Log::Instance()->SetFullPolicy(options.logFull, options.logSampleRate);
+        Log::Instance()->init(logLevel, "./log", ".log", logQueSize, options.logBinary);
+        if(!fullOk){
+            LOG_WARN("Bad log full policy: %s, using block", options.logFull.c_str());
+        }
+        if(!Log::Instance()->SetModuleLevels(options.logModules)){
+            LOG_WARN("Bad log module levels: %s", options.logModules.c_str());
+        }
         if(isClose_) {LOG_ERROR("========== Server init error!==========");}
         else{
             // 打印启动成功的详细信息，方便运维排查
             LOG_INFO("========== Server init ==========");
             LOG_INFO("Port:%d, OpenLinger: %s", port_, OptLinger? "true":"false");
             LOG_INFO("Listen Mode: %s, OpenConn Mode: %s", (listenEvent_ & EPOLLET ? "ET": "LT"), (connEvent_ & EPOLLET ? "ET": "LT"));
-            LOG_INFO("LogSys level: %d", logLevel);
+            LOG_INFO("LogSys level: %d, ring full: %s", logLevel, fullOk ? options.logFull.c_str() : "block");
             LOG_INFO("srcDir: %s", HttpConn::srcDir);
-            LOG_INFO("SqlConnPool num: %d, ThreadPool num: %d", connPoolNum, threadNum);
+            if(UserStore::Instance()) { LOG_INFO("User store: %s", UserStore::Instance()->Name()); }
+            else { LOG_ERROR("User store %s init failed, login/register disabled", options.userStore.c_str()); }
+            if(useMysql) {
+                LOG_INFO("SqlConnPool num: %d-%d (acquire %dms)", min(options.sqlMinConns, connPoolNum),
+                         connPoolNum, options.sqlAcquireMs);
+            }
+            LOG_INFO("ThreadPool num: %d%s", threadNum,
+                     options.workSteal ? (affinity_ ? " (work stealing, conn affinity)" : " (work stealing)") : "");
+            LOG_INFO("DB lane threads: %d, queue: %zu%s", options.dbThreads, options.dbQueueSize,
+                     coroutine_ ? " (coroutine handlers)" : "");
+            if(asyncSql_) { LOG_INFO("Async MySQL conns: %zu", asyncSql_->Size()); }
+            LOG_INFO("User cache: %zu entries, ttl %ds, filter %s", options.userCacheSize, options.userCacheTtl,
+                     UserCache::Instance()->FilterEnabled() ? "on" : "off");
+            LOG_INFO("Session ttl: %ds", options.sessionTtl);
+            if(GroupCommit::Instance()->Enabled()) {
+                LOG_INFO("Register group commit: batch %zu, window %dus", GroupCommit::Instance()->MaxBatch(),
+                         options.registerWindowUs);
+            }
+            if(options.shed || options.deadlineMs > 0) {
+                LOG_INFO("Load shedding: %s (target %dus, interval %dus), deadline %dms", options.shed ? "CoDel" : "off",
+                         options.shedTargetUs, options.shedIntervalUs, options.deadlineMs);
+            }
+            if(options.elastic && threadpool_) {
+                LOG_INFO("Elastic ThreadPool: %d-%d threads, target wait %dus, idle %dms",
+                         options.minThreads, options.maxThreads, options.targetWaitUs, options.idleMs);
+            }
         }
     }
+    // 错误页连同响应头一次性读入内存，之后 4xx/503 不再访问磁盘
+    HttpResponse::LoadErrorPages(srcDir_);
+    InitSignal_();
+    if(options.bundle) { InitBundle_(options); }
+    if(options.diskThreads > 0) { diskpool_.reset(new ThreadPool(options.diskThreads)); }
+    if(options.prewarm){
+        // 后台预读，不拖慢启动
+        string dir = srcDir_;
+        std::thread([dir]{
+            size_t bytes = PageCache::Prewarm(dir);
+            LOG_INFO("Prewarm %s: %zu bytes", dir.c_str(), bytes);
+        }).detach();
+    }
 }
 
 WebServer::~WebServer(){
@@ -85,12 +187,29 @@ void WebServer::Start(){
         // 如果开启了定时器，我们需要算出“离最近一个连接超时还有多久”
         // 比如最近一个连接将在 50ms 后超时，那 epoll_wait 最多只能等 50ms，
         // 醒来后好去处理那个超时连接。
-        if(timeoutMS_ > 0){
-            timeMs = timer_->GetNextTick();
+        timeMs = timeoutMS_ > 0 ? timer_->GetNextTick() : -1;
+        // 协程定时器（CoScheduler::Sleep）也要按时醒来
+        if(scheduler_){
+            int coMs = scheduler_->GetNextTick();
+            if(coMs >= 0 && (timeMs < 0 || coMs < timeMs)) { timeMs = coMs; }
         }
         // 2. 等待事件 (核心阻塞点)
         // 这一步会让出 CPU，直到有网络事件或超时
         int eventCnt = epoller_->Wait(timeMs);
+        // 醒来后先刷新缓存的 Date 头（每秒最多格式化一次），工作线程生成响应时直接拷贝
+        HttpResponse::UpdateDate();
+        if(reload_.exchange(false)){
+            LOG_INFO("SIGHUP: reload error pages");
+            HttpResponse::LoadErrorPages(srcDir_);
+        }
+        time_t now = time(nullptr);
+        if(statsInterval_ > 0 && now - lastStats_ >= statsInterval_){
+            LogLaneStats_();
+        }
+        if(now != lastSessionTick_){
+            lastSessionTick_ = now;
+            SessionStore::Instance()->Tick();
+        }
         // 3. 处理所有发生的事件
         for(int i = 0; i < eventCnt; i++){
             /* 处理事件 */
@@ -100,6 +219,13 @@ void WebServer::Start(){
             if(fd == listenFd_){
                 DealListen_();
             }
+            // 协程调度：其他线程投递的恢复任务 / 有协程在等待该 fd
+            else if(scheduler_ && fd == scheduler_->EventFd()){
+                scheduler_->RunReady();
+            }
+            else if(scheduler_ && scheduler_->OnEvent(fd, events)){
+                continue;
+            }
             // B. 处理异常/挂断 (错误或对端关闭)
             else if(events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)){
                 assert(users_.count(fd) > 0);
@@ -123,7 +249,11 @@ void WebServer::Start(){
 //!标准的写法是生成503报文
 void WebServer::SendError_(int fd, const char*info){
     assert(fd > 0);
-    int ret = send(fd, info, strlen(info), 0);
+    // 内存中的 503 页面（含完整响应头），未加载时退回发送纯文本
+    ssize_t ret = HttpResponse::SendErrorPage(fd, 503);
+    if(ret < 0) {
+        ret = send(fd, info, strlen(info), 0);
+    }
     if(ret < 0) {
         LOG_WARN("send error to client[%d] error!", fd);
     }
@@ -134,6 +264,7 @@ void WebServer::CloseConn_(HttpConn* client){
     assert(client);
     LOG_INFO("Client[%d] quit!", client->GetFd());
     epoller_->DelFd(client->GetFd());
+    if(scheduler_) { scheduler_->Cancel(client->GetFd()); }
     client->Close();
 }
 
@@ -177,13 +308,19 @@ void WebServer::DealRead_(HttpConn* client){
     ExtentTime_(client);
     // 2. 扔进线程池：将具体的 OnRead_ 函数绑定好参数，作为任务抛给线程池
     // 主线程立刻返回，继续去处理下一个 Epoll 事件
-    threadpool_->AddTask(std::bind(&WebServer::OnRead_, this, client));
+    int64_t enqueueUs = (codel_ || deadlineUs_ > 0) ? CoDel::NowUs() : 0;
+    if(!AddTask_(std::bind(&WebServer::OnRead_, this, client, enqueueUs), client)) {
+        // 3. 线程池队列已满（反压）：不阻塞主线程，重新挂回 epoll，下一轮 epoll_wait 再派发
+        epoller_->ModFd(client->GetFd(), connEvent_ | EPOLLIN);
+    }
 }
 
 void WebServer::DealWrite_(HttpConn* client){
     assert(client);
     ExtentTime_(client);
-    threadpool_->AddTask(std::bind(&WebServer::OnWrite_, this, client));
+    if(!AddTask_(std::bind(&WebServer::OnWrite_, this, client), client)) {
+        epoller_->ModFd(client->GetFd(), connEvent_ | EPOLLOUT);
+    }
 }
 
 void WebServer::ExtentTime_(HttpConn* client){
@@ -194,8 +331,15 @@ void WebServer::ExtentTime_(HttpConn* client){
 }
 
 //业务逻辑回调 (OnRead_, OnProcess, OnWrite_)在线程池里跑的代码
-void WebServer::OnRead_(HttpConn* client){
+void WebServer::OnRead_(HttpConn* client, int64_t enqueueUs){
     assert(client);
+    int64_t now = enqueueUs > 0 ? CoDel::NowUs() : 0;
+    // 排队太久，客户端多半已经超时放弃：不再读取和处理，直接关闭
+    if(deadlineUs_ > 0 && now - enqueueUs > deadlineUs_){
+        expired_.fetch_add(1, std::memory_order_relaxed);
+        CloseConn_(client);
+        return;
+    }
     int ret = -1;
     int readErrno = 0;
     ret = client -> read(&readErrno);
@@ -203,19 +347,160 @@ void WebServer::OnRead_(HttpConn* client){
         CloseConn_(client);
         return;
     }
+    // 过载：不解析请求，直接发送内存中预先生成的 503 页面后关闭
+    if(codel_ && codel_->ShouldDrop(now - enqueueUs, now)){
+        HttpResponse::SendErrorPage(client->GetFd(), 503);
+        CloseConn_(client);
+        return;
+    }
     OnProcess(client);
 }
 
 void WebServer::OnProcess(HttpConn* client){
-    // client->process() 会解析 HTTP 请求
-    if(client->process()){
-        // 成功生成响应 -> 修改监听事件为 EPOLLOUT
-        // 下次 Epoll 就会通知“可以写了”，然后触发 OnWrite_
-        epoller_->ModFd(client->GetFd(), connEvent_ | EPOLLOUT);
-    }else{
+    // client->parse() 会解析 HTTP 请求
+    if(!client->parse()){
         // 请求不完整 (半包) -> 继续监听 EPOLLIN，等剩下的数据来
         epoller_->ModFd(client->GetFd(), connEvent_ | EPOLLIN);
+        return;
+    }
+    // 登录/注册要同步查数据库 -> 派给阻塞通道，本线程马上回去处理页面和静态资源
+    if(coroutine_ && client->IsBlocking()){
+        scheduler_->Post(std::bind(&WebServer::HandleBlocking_, this, client));
+        return;
+    }
+    if(dbpool_ && client->IsBlocking()){
+        if(!dbpool_->TryAdd(dbStats_.Wrap(std::bind(&WebServer::OnRespond_, this, client, -1)))){
+            LOG_WARN("DB lane full, Client[%d] 503", client->GetFd());
+            OnRespond_(client, 503);
+        }
+        return;
+    }
+    OnRespond_(client, -1);
+}
+
+void WebServer::OnRespond_(HttpConn* client, int code){
+    assert(client);
+    client->respond(code, diskpool_ != nullptr);
+    // 响应文件不在页缓存中或需要压缩 -> 先交给磁盘 I/O 线程读盘/压缩，完成后再监听 EPOLLOUT
+    if(diskpool_){
+        auto loader = client->ColdFileLoader();
+        if(loader){
+            uint32_t generation = client->Generation();
+            if(diskpool_->TryAdd([this, client, generation, loader]{ OnLoadFile_(client, generation, loader); })){
+                return;
+            }
+            // 磁盘线程队列已满：不等待，压缩在本线程完成，冷文件直接发送（缺页由 writev 承担）
+            LOG_DEBUG("Disk lane full, Client[%d] load inline", client->GetFd());
+            client->FinishLoad(true);
+        }
+    }
+    // 成功生成响应 -> 修改监听事件为 EPOLLOUT
+    // 下次 Epoll 就会通知“可以写了”，然后触发 OnWrite_
+    epoller_->ModFd(client->GetFd(), connEvent_ | EPOLLOUT);
+}
+
+CoHandler WebServer::HandleBlocking_(HttpConn* client){
+    assert(client);
+    int fd = client->GetFd();
+    // 挂起期间连接可能被定时器关闭、fd 也可能已分给新连接：每次恢复后比较代数，变了就不再访问 client
+    uint32_t generation = client->Generation();
+    ExtentTime_(client);
+    std::string name, pwd;
+    bool isLogin = false;
+    bool done = false;
+    // 1. 非阻塞 MySQL：查询期间协程挂起，数据库 socket 的事件由 Reactor 驱动，不占用任何线程
+    // 非阻塞连接全部断开（正在后台重连）时退回阻塞通道
+    if(asyncSql_ && asyncSql_->Size() > 0 && client->LoginForm(&name, &pwd, &isLogin)){
+        bool verified = co_await asyncSql_->UserVerify(std::move(name), std::move(pwd), isLogin);
+        if(client->Generation() != generation) { co_return; }
+        client->SetVerified(verified);
+        // 生成响应（stat/mmap/压缩）不占用 Reactor 线程：交给阻塞通道，通道满时才在这里生成
+        bool queued = co_await scheduler_->Run(*dbpool_, [client]{ client->respond(-1); }, &dbStats_);
+        if(client->Generation() != generation) { co_return; }
+        if(!queued) { client->respond(-1); }
+        done = true;
+    }
+    // 1'. 否则数据库操作和生成响应交给阻塞通道，协程挂起；通道满时稍等重试，仍失败回复 503
+    for(int retry = 0; !done && retry < CO_RETRY; retry++){
+        if(retry > 0) {
+            co_await scheduler_->Sleep(CO_RETRY_MS);
+            if(client->Generation() != generation) { co_return; }
+        }
+        done = co_await scheduler_->Run(*dbpool_, [client]{ client->respond(-1); }, &dbStats_);
+        if(client->Generation() != generation) { co_return; }
+    }
+    if(!done){
+        LOG_WARN("DB lane full, Client[%d] 503", fd);
+        client->respond(503);
+    }
+    // 2. 回到 Reactor 线程发送响应，写满内核缓冲区时等待可写
+    while(client->ToWriteBytes() > 0){
+        int writeErrno = 0;
+        if(client->write(&writeErrno) < 0){
+            if(writeErrno != EAGAIN) { break; }
+            if(!co_await scheduler_->Writable(fd, connEvent_)) { co_return; }   // 连接已关闭
+            if(client->Generation() != generation) { co_return; }
+        }
+    }
+    // 3. 长连接交回线程池继续处理后续请求，否则关闭
+    if(client->ToWriteBytes() == 0 && client->IsKeepAlive()){
+        if(!AddTask_(std::bind(&WebServer::OnProcess, this, client), client)){
+            epoller_->ModFd(fd, connEvent_ | EPOLLIN);
+        }
+        co_return;
+    }
+    CloseConn_(client);
+}
+
+void WebServer::LogLaneStats_(){
+    lastStats_ = time(nullptr);
+    if(codel_ || deadlineUs_ > 0){
+        LOG_INFO("Shed: 503 %lu, expired %lu%s", (unsigned long)(codel_ ? codel_->TakeDrops() : 0),
+                 (unsigned long)expired_.exchange(0), codel_ && codel_->Dropping() ? " (dropping)" : "");
     }
+    UserCache* cache = UserCache::Instance();
+    if(cache->Enabled() || cache->FilterEnabled()){
+        UserCache::Stats u = cache->Take();
+        LOG_INFO("User cache: hit %lu, miss %lu, filtered %lu", (unsigned long)u.hits,
+                 (unsigned long)u.misses, (unsigned long)u.filtered);
+    }
+    SqlConnPool::Stats sql = SqlConnPool::Instance()->TakeStats();
+    if(sql.maxConn > 0){// 未初始化（非 mysql 用户存储）时不输出
+        LOG_INFO("SqlConnPool: conns %d/%d, in use %d (peak %d), acquires %lu, wait avg %luus max %luus, timeouts %lu",
+                 sql.total, sql.maxConn, sql.inUse, sql.peak, (unsigned long)sql.wait.tasks,
+                 (unsigned long)sql.wait.avgUs, (unsigned long)sql.wait.maxUs, (unsigned long)sql.timeouts);
+    }
+    GroupCommit::Stats reg = GroupCommit::Instance()->Take();
+    if(reg.rows > 0){
+        LOG_INFO("Register commits: %lu rows in %lu batches", (unsigned long)reg.rows, (unsigned long)reg.batches);
+    }
+    LaneStats* lanes[] = {&cpuStats_, &dbStats_};
+    ThreadPool* pools[] = {threadpool_.get(), dbpool_.get()};
+    for(int i = 0; i < 2; i++){
+        LaneStats::Snapshot s = lanes[i]->Take();
+        size_t threads = 0, queued = 0;
+        if(pools[i]){
+            threads = pools[i]->Threads();
+            queued = pools[i]->QueueSize();
+        }
+        else if(i == 0 && stealpool_){// 请求通道使用工作窃取线程池
+            threads = stealpool_->Threads();
+            queued = stealpool_->QueueSize();
+        }
+        LOG_INFO("Lane %s: threads %zu, tasks %lu, queued %zu, wait avg %luus max %luus", lanes[i]->Name(),
+                 threads, (unsigned long)s.tasks, queued, (unsigned long)s.avgUs, (unsigned long)s.maxUs);
+    }
+}
+
+void WebServer::OnLoadFile_(HttpConn* client, uint32_t generation, const std::function<void()>& loader){
+    assert(client);
+    loader();
+    // 读盘期间定时器可能已关闭连接、fd 也可能已分给新连接：回到 Reactor 线程（定时器也在这里执行）再确认
+    scheduler_->Post([this, client, generation]{
+        if(client->Generation() != generation) { return; }
+        client->FinishLoad(false);
+        epoller_->ModFd(client->GetFd(), connEvent_ | EPOLLOUT);
+    });
 }
 
 void WebServer::OnWrite_(HttpConn* client){
@@ -260,13 +545,13 @@ bool WebServer::InitSocket_(){
     }
     listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
     if(listenFd_ < 0){
-        LOG_ERROR("Create socket error!", port_);
+        LOG_ERROR("Create socket error! port:%d", port_);
         return false;
     }
     ret = setsockopt(listenFd_, SOL_SOCKET, SO_LINGER, &optLinger, sizeof(optLinger));
     if(ret < 0){
         close(listenFd_);
-        LOG_ERROR("Init linger error!", port_);
+        LOG_ERROR("Init linger error! port:%d", port_);
         return false;
     }
 
@@ -305,6 +590,31 @@ bool WebServer::InitSocket_(){
     return true;
 }
 
+void WebServer::InitBundle_(const ServerOptions& options){
+    if(options.packBundle && !ResourceBundle::Pack(srcDir_, options.bundleFile)){
+        LOG_ERROR("Pack resource bundle error, serve from %s", srcDir_);
+        return;
+    }
+    if(!ResourceBundle::Instance()->Open(options.bundleFile)){
+        LOG_ERROR("Open resource bundle error, serve from %s", srcDir_);
+    }
+}
+
+void WebServer::InitSignal_(){
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = OnSighup_;
+    sigemptyset(&sa.sa_mask);
+    // 不设置 SA_RESTART：epoll_wait 被信号打断后立即返回，事件循环马上处理重载
+    if(sigaction(SIGHUP, &sa, nullptr) < 0){
+        LOG_WARN("Install SIGHUP handler error!");
+    }
+}
+
+void WebServer::OnSighup_(int){
+    reload_ = true;
+}
+
 int WebServer::SetFdNonblock(int fd){
     assert(fd > 0);
     return fcntl(fd, F_SETFL, fcntl(fd, F_GETFD, 0) | O_NONBLOCK);
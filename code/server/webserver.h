@@ -6,19 +6,113 @@
 #include <unistd.h>
 #include <assert.h>
 #include <errno.h>
+#include <signal.h>
 //用于建立网络连接
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
 #include "epoller.h"
+#include "coscheduler.h"
+#include "asyncsql.h"
 #include "../log/log.h"
 #include "../timer/heaptimer.h"
 #include "../pool/sqlconnpool.h"
 #include "../pool/threadpool.h"
+#include "../pool/workstealpool.h"
+#include "../pool/lanestats.h"
+#include "../pool/codel.h"
 #include "../pool/sqlconnRAII.h"
+#include "../pool/mysqluserstore.h"
+#include "../pool/sqliteuserstore.h"
+#include "../pool/memuserstore.h"
 #include "../http/httpconn.h"
 
+// 可选特性配置
+struct ServerOptions{
+    // 资源包模式：启动时把 resources/ 打包成一个文件并整体 mmap，静态请求直接查包内索引
+    bool bundle = false;
+    // 资源包路径
+    std::string bundleFile = "./resources.bundle";
+    // 启动时是否重新打包；为 false 时直接映射事先（如构建阶段）打好的包
+    bool packBundle = true;
+    // 启动时在后台把资源目录预读进页缓存
+    bool prewarm = false;
+    // 磁盘 I/O 线程数：响应文件不在页缓存时由这些线程读盘，压缩缓存未命中的文件也在这里压缩，
+    // 工作线程不会阻塞在缺页和压缩上；队列满时退回在工作线程处理；0 表示关闭（默认）
+    int diskThreads = 0;
+    // 使用工作窃取线程池处理请求（每线程本地无锁队列 + 提交队列），否则使用单队列的 ThreadPool
+    bool workSteal = false;
+    // 请求线程池的任务队列容量（有界无锁队列）；队列满时暂不派发，重新挂回 epoll 等下一轮
+    size_t taskQueueSize = 4096;
+    // 连接亲和调度（需开启 workSteal）：按连接 fd 把同一连接的读/写任务优先派给固定线程，线程忙时由其他线程窃取。
+    // 只是尽力而为：为了不让任务排在慢任务之后，主人一忙就会被窃取，没有测到稳定的 LLC 命中或 p99 收益，默认关闭
+    bool affinity = false;
+    // 阻塞通道（登录/注册等同步 MySQL 操作）的线程数与队列容量；0 表示不分通道，在请求线程池里直接查库
+    // 阻塞通道满时登录请求直接回复 503，数据库再慢也不会占满处理页面和静态资源的线程
+    int dbThreads = 4;
+    size_t dbQueueSize = 256;
+    // 每隔多少秒输出一次各通道的排队等待统计；0 表示不输出
+    int statsInterval = 60;
+    // 弹性线程池（不与 workSteal 同时使用）：threadNum 为初始线程数，在 [minThreads, maxThreads] 间伸缩；
+    // 排队时间超过 targetWaitUs 扩容，空闲 idleMs 缩容，每次伸缩写一条日志
+    bool elastic = false;
+    int minThreads = 2;
+    int maxThreads = 32;
+    int targetWaitUs = 2000;
+    int idleMs = 30000;
+    // 过载保护（CoDel）：读任务排队时间持续 shedIntervalUs 高于 shedTargetUs 时，
+    // 按 CoDel 节奏对新请求直接回复内存中的 503，不再解析和生成响应
+    bool shed = false;
+    int shedTargetUs = 5000;
+    int shedIntervalUs = 100000;
+    // 读任务排队超过该时间（客户端多半已超时放弃）直接关闭连接；0 表示不检查
+    int deadlineMs = 0;
+    // 协程模式（需 dbThreads > 0）：登录/注册由 Reactor 线程上的协程处理，
+    // co_await 阻塞通道的数据库结果和 socket 可写，不再为每个请求占着一个线程等待回写
+    bool coroutine = false;
+    // 非阻塞 MySQL（需 coroutine，且客户端库为 MariaDB Connector/C）：连接 socket 注册在 epoll 中，
+    // 登录/注册在 Reactor 线程上挂起等待数据库，不占用阻塞通道的线程；0 表示不开启
+    int asyncSqlConns = 0;
+    // 用户存储后端（见 UserStore）："mysql"（默认）、"sqlite"（嵌入式数据库文件 sqliteFile）、
+    // "memory"（进程内无锁哈希表，最多 memoryUsers 个用户，不落盘）。后两者不连接 MySQL
+    std::string userStore = "mysql";
+    std::string sqliteFile = "./users.db";
+    size_t memoryUsers = 1 << 20;
+    // 进程内用户缓存（见 UserCache）：条目上限（0 表示不缓存）和有效期（秒）。只缓存密码的带密钥摘要；
+    // 其他途径修改的密码在 userCacheTtl 内旧密码仍能登录，有此类写入者时调小或设为 0
+    size_t userCacheSize = 10000;
+    int userCacheTtl = 60;
+    // 用户名布隆过滤器：启动时载入全部用户名，未知用户的登录/注册不查数据库。
+    // 仅当本进程是 user 表唯一的写入者时开启
+    bool userFilter = false;
+    // 数据库连接池（见 SqlConnPool::Options）：常驻连接数（上限为 connPoolNum）、取连接的等待期限、
+    // 连接/读写超时、空闲连接 ping 间隔、多余连接的空闲关闭时间
+    int sqlMinConns = 2;
+    int sqlAcquireMs = 500;
+    int sqlTimeoutSec = 3;
+    int sqlPingSec = 30;
+    int sqlIdleSec = 60;
+    // 注册组提交（见 GroupCommit）：一批最多合并的注册数和等待其他注册加入的窗口（微秒）。
+    // 一批不会超过阻塞通道线程数（dbThreads，未分通道时为 threadNum），超出的值按线程数算；
+    // 0（默认）表示取该线程数，1 表示不合并
+    size_t registerBatch = 0;
+    int registerWindowUs = 1000;
+    // 异步日志的刷新策略（见 Log::SetFlushPolicy，同步日志每行写入）：文件缓冲攒满 logFlushKB 或距上次刷新超过 logFlushMs 时写入，ERROR 立即写入
+    int logFlushMs = 1000;
+    size_t logFlushKB = 64;
+    // 分模块日志级别（http/server/timer/pool/core），如 "pool=0" 只对连接池打开 debug；未列出的模块使用 logLevel
+    std::string logModules = "";
+    // 二进制日志：调用线程只记录格式编号和原始参数，写入 *.log.bin，用 bin/logdecode 还原成文本
+    bool logBinary = false;
+    // 线程日志环满时的处理（见 Log::SetFullPolicy）：block/drop_newest/drop_oldest/sample，
+    // sample 在环内过半后只保留每 logSampleRate 行中的一行（ERROR 不抽样）
+    std::string logFull = "block";
+    int logSampleRate = 10;
+    // 登录会话有效期（秒，空闲超过即过期）：带有效会话 Cookie 的登录不再查数据库；0 表示不下发会话
+    int sessionTtl = 1800;
+};
+
 class WebServer{
 public:
     // 构造函数：初始化服务器的各种参数
@@ -26,7 +120,8 @@ public:
         int port, int trigmODE, int timeoutMs, bool OptLinger,  // 网络与超时配置
         int sqlPort, const char* sqlUser, const char* sqlPwd,   // 数据库配置
         const char* dbName, int connPoolNum, int threadNum,     // 资源池配置
-        bool openLog, int logLevel, int logQueSize              // 日志配置
+        bool openLog, int logLevel, int logQueSize,             // 日志配置
+        const ServerOptions& options = ServerOptions()          // 可选特性
     );
     ~WebServer();// 析构函数：释放资源（关闭 socket，停止线程池等）
     void Start();// 【启动按钮】：调用后服务器开始无限循环运行
@@ -46,29 +141,61 @@ private:
     //主线程读取数据 -> 放入 client 的读缓冲区 -> 将任务扔给线程池。
     void DealRead_(HttpConn* client);
 
-    //发送错误信息（如服务器繁忙）
+    //资源包模式：打包并映射资源目录
+    void InitBundle_(const ServerOptions& options);
+    //发送错误信息（如服务器繁忙），优先发送内存中的 503 页面
     void SendError_(int fd, const char* info);
+    //注册 SIGHUP：收到后在事件循环中重新加载内存错误页
+    void InitSignal_();
+    static void OnSighup_(int sig);
     //如果客人有动作，重置他的超时时间，防止被定时器踢掉。
     void ExtentTime_(HttpConn* client);
     //关闭连接，从 epoll 中移除，释放资源。
     void CloseConn_(HttpConn* client);
 
-    //具体的读取逻辑
-    void OnRead_(HttpConn* client);
+    //具体的读取逻辑；enqueueUs 为任务入队时刻（开启过载保护时记录，否则为 0）
+    void OnRead_(HttpConn* client, int64_t enqueueUs);
     //具体的发送逻辑
     void OnWrite_(HttpConn* client);
     //解析 HTTP 请求 -> 生成 HTTP 响应。
     void OnProcess(HttpConn* client);
+    //生成响应（请求线程池或阻塞通道中执行），然后监听 EPOLLOUT
+    void OnRespond_(HttpConn* client, int code);
+    //协程处理阻塞请求（登录/注册）：数据库操作 -> 等待可写 -> 发送，全程在 Reactor 线程恢复
+    CoHandler HandleBlocking_(HttpConn* client);
+    //磁盘 I/O 线程：把冷文件读入页缓存，然后回到 Reactor 线程，连接仍是 generation 那一代时再监听 EPOLLOUT
+    void OnLoadFile_(HttpConn* client, uint32_t generation, const std::function<void()>& loader);
 
     static const int MAX_FD = 65536;
+    // 协程模式下阻塞通道满时的重试次数与间隔 (毫秒)，仍失败则回复 503
+    static const int CO_RETRY = 3;
+    static const int CO_RETRY_MS = 10;
 
     static int SetFdNonblock(int fd);
 
+    //把 client 的任务交给请求线程池（CPU 通道：工作窃取池或普通线程池）；队列已满返回 false
+    template<class F>
+    bool AddTask_(F&& task, HttpConn* client) {
+        if(stealpool_) {
+            if(affinity_) { stealpool_->AddTask(cpuStats_.Wrap(std::forward<F>(task)), static_cast<size_t>(client->GetFd())); }
+            else { stealpool_->AddTask(cpuStats_.Wrap(std::forward<F>(task))); }
+            return true;
+        }
+        return threadpool_->TryAdd(cpuStats_.Wrap(std::forward<F>(task)));
+    }
+    //输出各通道排队等待统计（事件循环中每 statsInterval_ 秒一次）
+    void LogLaneStats_();
+
+    // SIGHUP 标记，信号处理函数只置位，由事件循环执行真正的重载
+    static std::atomic<bool> reload_;
+
     // 1. 基础配置
     int port_;// 端口号
     bool openLinger_;// 是否优雅关闭
     int timeoutMS_;  // 超时时间 (毫秒)，超过这个时间不发请求就会被断开
     bool isClose_;   // 服务器是否停止运行
+    bool affinity_;  // 是否按连接亲和派发任务 (ServerOptions::affinity)
+    bool coroutine_; // 登录/注册是否由协程处理 (ServerOptions::coroutine)
     int listenFd_;   // 监听的文件描述符 (大门)
     char* srcDir_;   // 网站根目录路径 (HTML文件存放处)
 
@@ -79,7 +206,20 @@ private:
     // 3. 核心子系统 (使用智能指针 unique_ptr 管理生命周期)
     std::unique_ptr<HeapTimer> timer_;  // 定时器堆 (管理超时连接)
     std::unique_ptr<ThreadPool> threadpool_;    // 线程池 (处理计算密集型任务)
+    std::unique_ptr<WorkStealPool> stealpool_;  // 工作窃取线程池 (ServerOptions::workSteal 开启时代替 threadpool_)
+    std::unique_ptr<ThreadPool> diskpool_;      // 磁盘 I/O 线程池 (读入不在页缓存中的文件)
+    std::unique_ptr<ThreadPool> dbpool_;        // 阻塞通道 (登录/注册等同步数据库操作)
+    LaneStats cpuStats_;    // 请求线程池的排队等待统计
+    LaneStats dbStats_;     // 阻塞通道的排队等待统计
+    std::unique_ptr<CoDel> codel_;      // 读任务过载丢弃 (ServerOptions::shed)
+    int64_t deadlineUs_;                // 读任务最长排队时间 (微秒)，0 表示不检查
+    std::atomic<uint64_t> expired_;     // 因排队超时而关闭的连接数
+    int statsInterval_;     // 统计输出间隔 (秒)
+    time_t lastStats_;      // 上次输出统计的时间
+    time_t lastSessionTick_;    // 上次清理过期会话的时间（每秒一次）
     std::unique_ptr<Epoller> epoller_;  // Epoll 对象 (IO 多路复用)
+    std::unique_ptr<CoScheduler> scheduler_;    // 协程调度器 (ServerOptions::coroutine)，也把磁盘 I/O 线程的完成通知交回 Reactor 线程；先于 epoller_ 析构
+    std::unique_ptr<AsyncSql> asyncSql_;        // 非阻塞 MySQL 连接 (ServerOptions::asyncSqlConns)，先于 scheduler_ 析构
     // 4. 客户名单
     // key: 文件描述符 fd (int)
     // value: 具体的连接对象 (HttpConn)
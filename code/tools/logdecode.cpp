@@ -0,0 +1,101 @@
+// 二进制日志解码工具：把 Log 二进制模式写出的 *.bin 文件还原成与文本模式相同格式的日志行，输出到标准输出。
+// 用法：logdecode <file.bin>...
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include "../log/logrender.h"
+
+using namespace std;
+
+namespace {
+
+string Timestamp(uint64_t ns) {
+    time_t sec = ns / 1000000000;
+    struct tm t;
+    localtime_r(&sec, &t);
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%d-%02d-%02d %02d:%02d:%02d.%06ld ",
+             t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec,
+             (long)(ns % 1000000000 / 1000));
+    return buf;
+}
+
+bool Decode(const char* file) {
+    FILE* fp = fopen(file, "rb");
+    if(!fp) { perror(file); return false; }
+    string data;
+    char chunk[1 << 16];
+    size_t n;
+    while((n = fread(chunk, 1, sizeof(chunk), fp)) > 0) { data.append(chunk, n); }
+    fclose(fp);
+
+    vector<string> formats;
+    size_t pos = 0;
+    while(pos < data.size()) {
+        const char* p = data.data() + pos;
+        size_t left = data.size() - pos;
+        uint8_t type = p[0];
+        if(type == logbin::MAGIC_TYPE) {
+            if(left < logbin::MAGIC_LEN || memcmp(p, logbin::MAGIC, logbin::MAGIC_LEN) != 0) { break; }
+            formats.clear();
+            pos += logbin::MAGIC_LEN;
+        } else if(type == logbin::FORMAT) {
+            if(left < 7) { break; }
+            uint32_t id;
+            uint16_t len;
+            memcpy(&id, p + 1, 4);
+            memcpy(&len, p + 5, 2);
+            if(left < 7u + len) { break; }
+            if(formats.size() <= id) { formats.resize(id + 1); }
+            formats[id].assign(p + 7, len);
+            pos += 7 + len;
+        } else if(type == logbin::RECORD) {
+            if(left < logbin::RECORD_HEADER) { break; }
+            uint16_t argLen;
+            uint32_t id;
+            uint64_t ns;
+            memcpy(&argLen, p + 2, 2);
+            memcpy(&id, p + 4, 4);
+            memcpy(&ns, p + 8, 8);
+            if(left < logbin::RECORD_HEADER + argLen) { break; }
+            string line = Timestamp(ns) + logbin::LevelTitle(p[1]);
+            if(id < formats.size()) {
+                line += logbin::Render(formats[id], logbin::ParseArgs(p + logbin::RECORD_HEADER, argLen));
+            } else {
+                line += "<unknown format " + to_string(id) + ">";
+            }
+            puts(line.c_str());
+            pos += logbin::RECORD_HEADER + argLen;
+        } else if(type == logbin::TEXT) {
+            if(left < 4) { break; }
+            uint16_t len;
+            memcpy(&len, p + 2, 2);
+            if(left < 4u + len) { break; }
+            fwrite(p + 4, 1, len, stdout);
+            pos += 4 + len;
+        } else {
+            break;
+        }
+    }
+    if(pos < data.size()) {
+        fprintf(stderr, "%s: corrupt or truncated at offset %zu\n", file, pos);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if(argc < 2) {
+        fprintf(stderr, "usage: %s <file.bin>...\n", argv[0]);
+        return 2;
+    }
+    bool ok = true;
+    for(int i = 1; i < argc; i++) {
+        ok = Decode(argv[i]) && ok;
+    }
+    return ok ? 0 : 1;
+}
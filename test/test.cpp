@@ -1,7 +1,18 @@
 
 #include "../code/log/log.h"
 #include "../code/pool/threadpool.h"
+#include "../code/http/compressor.h"
+#include "../code/pool/codel.h"
+#include "../code/pool/usercache.h"
+#include "../code/http/httprequest.h"
+#include "../code/pool/groupcommit.h"
+#include "../code/pool/memuserstore.h"
+#include "../code/log/logring.h"
+#include "../code/log/logrender.h"
 #include <features.h>
+#include <assert.h>
+#include <thread>
+#include <chrono>
 
 
 #if __GLIBC__ == 2 && __GLIBC_MINOR__ < 30
@@ -47,7 +58,599 @@ void TestThreadPool() {
     getchar();
 }
 
+void TestCompressor() {
+    typedef Compressor C;
+    assert(C::Negotiate("") == C::IDENTITY);
+    assert(C::Negotiate("gzip, deflate, br") == C::GZIP);
+    assert(C::Negotiate("deflate") == C::DEFLATE);
+    assert(C::Negotiate("GZip;q=0.5 , deflate") == C::GZIP);
+    assert(C::Negotiate("gzip;q=0, deflate") == C::DEFLATE);
+    assert(C::Negotiate("*") == C::GZIP);
+    /* 明确列出的编码优先于 "*"，与出现的先后顺序无关 */
+    assert(C::Negotiate("gzip;q=0, *") == C::DEFLATE);
+    assert(C::Negotiate("*, gzip;q=0, deflate;q=0") == C::IDENTITY);
+    assert(C::Negotiate("*;q=0, deflate") == C::DEFLATE);
+    assert(C::Negotiate("*;q=0") == C::IDENTITY);
+
+    assert(C::Compressible("text/html") && C::Compressible("application/json"));
+    assert(!C::Compressible("image/png"));
+    assert(!C::ShouldCompress("text/html", C::MIN_SIZE - 1));
+    assert(C::ShouldCompress("text/html", C::MIN_SIZE));
+
+    std::string data(4096, 'a'), out;
+    assert(C::Compress(data.data(), data.size(), C::GZIP, out));
+    assert(out.size() < data.size() && (unsigned char)out[0] == 0x1f && (unsigned char)out[1] == 0x8b);
+    auto first = C::Instance()->Get("/test", 1, C::GZIP, data.data(), data.size());
+    auto second = C::Instance()->Get("/test", 1, C::GZIP, data.data(), data.size());
+    assert(first && first == second);
+    printf("TestCompressor ok\n");
+}
+
+void TestMpmcQueue() {
+    MpmcQueue<int> q(3);
+    assert(q.Capacity() == 4);      // 向上取整为 2 的幂
+    int v;
+    assert(!q.TryPop(v) && q.Empty());
+    for(int i = 0; i < 4; i++) { assert(q.TryPush(i)); }
+    assert(!q.TryPush(4) && q.Size() == 4);
+    for(int i = 0; i < 4; i++) { assert(q.TryPop(v) && v == i); }
+    assert(!q.TryPop(v));
+    /* 读写位置绕环多圈，先进先出不变 */
+    int next = 0, expect = 0;
+    for(int round = 0; round < 1000; round++) {
+        while(q.TryPush(next)) { next++; }
+        for(int k = 0; k < 3 && q.TryPop(v); k++) { assert(v == expect++); }
+    }
+    while(q.TryPop(v)) { assert(v == expect++); }
+    assert(expect == next && q.Empty());
+    printf("TestMpmcQueue ok\n");
+}
+
+struct Counted {
+    static int alive;
+    int* hits;
+    explicit Counted(int* h): hits(h) { alive++; }
+    Counted(Counted&& o): hits(o.hits) { alive++; }
+    ~Counted() { alive--; }
+    void operator()() { (*hits)++; }
+};
+int Counted::alive = 0;
+
+void TestTask() {
+    int hits = 0;
+    {
+        Task a{Counted(&hits)};
+        assert(a && Counted::alive == 1);
+        a();
+        Task b(std::move(a));
+        assert(!a && b && Counted::alive == 1);
+        b();
+        Task c;
+        assert(!c);
+        c = std::move(b);
+        c();
+        /* 赋值时析构原先持有的对象 */
+        c = Task([&hits]{ hits += 10; });
+        assert(Counted::alive == 0);
+        c();
+    }
+    assert(hits == 13 && Counted::alive == 0);
+    printf("TestTask ok\n");
+}
+
+// 等待 done 达到 n，最多 1 秒
+static bool WaitCount(std::atomic<int>& done, int n) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while(done.load() < n && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    return done.load() == n;
+}
+
+void TestPoolQueueFull() {
+    ThreadPool pool(1, 4);
+    std::atomic<bool> release(false);
+    std::atomic<int> done(0);
+    /* 唯一的工作线程被第一个任务占住，队列容量 4，第 5 个排队任务 TryAdd 失败 */
+    pool.AddTask([&]{ while(!release.load()) { std::this_thread::yield(); } done++; });
+    for(int i = 0; i < 1000 && pool.QueueSize() > 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for(int i = 0; i < 4; i++) { assert(pool.TryAdd([&]{ done++; })); }
+    assert(!pool.TryAdd([&]{ done++; }));
+    release = true;
+    assert(WaitCount(done, 5));
+    assert(pool.QueueSize() == 0);
+    printf("TestPoolQueueFull ok\n");
+}
+
+void TestPoolParkWake() {
+    /* 每次提交时工作线程都可能正在登记空闲：任一次唤醒丢失都会卡住等待 */
+    ThreadPool pool(1, 16);
+    std::atomic<int> done(0);
+    for(int i = 1; i <= 20000; i++) {
+        pool.AddTask([&]{ done++; });
+        if(i % 1000 == 0) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+        assert(WaitCount(done, i));
+    }
+    printf("TestPoolParkWake ok\n");
+}
+
+void TestCoDel() {
+    /* target 5ms, interval 100ms；时间全部由调用方给出，结果是确定的 */
+    CoDel codel(5000, 100000);
+    int64_t t = 1000000;
+    assert(!codel.ShouldDrop(1000, t) && !codel.Dropping());
+    /* 超过 target 后要持续一个 interval 才进入丢弃状态 */
+    assert(!codel.ShouldDrop(6000, t));
+    assert(!codel.ShouldDrop(6000, t + 50000) && !codel.Dropping());
+    assert(codel.ShouldDrop(6000, t + 100000) && codel.Dropping());
+    /* 第 n 次丢弃后间隔 interval / sqrt(n) */
+    assert(!codel.ShouldDrop(6000, t + 150000));
+    assert(codel.ShouldDrop(6000, t + 200000));
+    assert(!codel.ShouldDrop(6000, t + 270709));
+    assert(codel.ShouldDrop(6000, t + 270710));
+    assert(codel.TakeDrops() == 3 && codel.TakeDrops() == 0);
+    /* 排队时间回落到 target 以下立即离开丢弃状态 */
+    assert(!codel.ShouldDrop(1000, t + 300000) && !codel.Dropping());
+    /* 不久后再次进入：count 从 3 - 2 继续，第一次丢弃后间隔 interval / sqrt(2) */
+    t += 300001;
+    assert(!codel.ShouldDrop(6000, t));
+    assert(codel.ShouldDrop(6000, t + 100000));
+    assert(!codel.ShouldDrop(6000, t + 170709));
+    assert(codel.ShouldDrop(6000, t + 170710));
+    printf("TestCoDel ok\n");
+}
+
+void TestUserCache() {
+    UserCache* cache = UserCache::Instance();
+    bool match = false;
+    /* 容量为 0 时不缓存 */
+    cache->Init(0, 60);
+    cache->Put("alice", "pw1");
+    assert(!cache->Get("alice", "pw1", &match));
+
+    cache->Init(16 * 4, 60);        // 每个分片 4 条
+    cache->Take();
+    cache->Put("alice", "pw1");
+    assert(cache->Get("alice", "pw1", &match) && match);
+    assert(cache->Get("alice", "wrong", &match) && !match);
+    /* 注册/改密写入后以新密码为准 */
+    cache->Put("alice", "pw2");
+    assert(cache->Get("alice", "pw2", &match) && match);
+    assert(cache->Get("alice", "pw1", &match) && !match);
+    assert(!cache->Get("bob", "pw", &match));
+    UserCache::Stats st = cache->Take();
+    assert(st.hits == 4 && st.misses == 1 && st.filtered == 0);
+
+    /* 每个分片按 LRU 淘汰，总条目不超过容量，最近写入的一定还在 */
+    char name[32];
+    for(int i = 0; i < 1000; i++) {
+        snprintf(name, sizeof(name), "user%d", i);
+        cache->Put(name, "pw");
+    }
+    int hits = 0;
+    for(int i = 0; i < 1000; i++) {
+        snprintf(name, sizeof(name), "user%d", i);
+        if(cache->Get(name, "pw", &match)) { hits++; }
+    }
+    assert(hits > 0 && hits <= 16 * 4);
+    assert(cache->Get("user999", "pw", &match) && match);
+
+    /* TTL 为 0：条目写入即过期，下次查询回数据库 */
+    cache->Init(16 * 4, 0);
+    cache->Put("carol", "pw");
+    assert(!cache->Get("carol", "pw", &match));
+    cache->Init(0, 60);
+    cache->Take();
+    printf("TestUserCache ok\n");
+}
+
+// 解析一个带 Cookie 的登录表单请求
+static void ParseLogin(HttpRequest& req, const std::string& cookie, const std::string& user) {
+    std::string body = "username=" + user + "&password=x";
+    std::string text = "POST /login HTTP/1.1\r\nContent-Type: application/x-www-form-urlencoded\r\n"
+                       "Cookie: a=1; " + std::string(SessionStore::COOKIE_NAME) + "=" + cookie + "\r\n"
+                       "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    Buffer buff;
+    buff.Append(text);
+    req.Init();
+    assert(req.parse(buff) && req.state() == HttpRequest::FINISH);
+}
+
+void TestSessionStore() {
+    SessionStore* store = SessionStore::Instance();
+    std::string user;
+    store->Init(0);
+    assert(store->Create("alice").empty() && !store->Check("x", &user));
+
+    store->Init(1);
+    std::string cookie = store->Create("alice");
+    assert(store->Check(cookie, &user) && user == "alice");
+    /* 签名被改动、长度不对或会话不存在都被拒绝 */
+    std::string forged = cookie;
+    forged.back() = forged.back() == '0' ? '1' : '0';
+    assert(!store->Check(forged, &user));
+    assert(!store->Check(cookie.substr(1), &user));
+    std::string other = cookie;
+    other[0] = other[0] == '0' ? '1' : '0';
+    assert(!store->Check(other, &user));
+
+    /* 命中的会话续期并重新下发同一 Cookie；不同用户名不算命中 */
+    HttpRequest req;
+    ParseLogin(req, cookie, "alice");
+    assert(req.path() == "/welcome.html" && req.NewSession() == cookie);
+    ParseLogin(req, cookie, "bob");
+    assert(req.path() == "/login.html" && req.NewSession().empty());
+
+    /* TTL 1 秒：每 0.6 秒访问一次一直有效，停止访问超过 1 秒后过期 */
+    for(int i = 0; i < 2; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(600));
+        assert(store->Check(cookie, &user));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    store->Tick();
+    assert(!store->Check(cookie, &user));
+    store->Init(0);
+    printf("TestSessionStore ok\n");
+}
+
+void TestGroupCommit() {
+    /* 用假的 Executor 代替数据库：第一批阻塞住，观察其间到达的注册如何合并 */
+    const int K = 6;
+    std::mutex mtx;
+    std::condition_variable cond;
+    bool release = false;
+    std::vector<size_t> sizes;
+    auto executor = [&](const std::vector<GroupCommit::Item>& items, std::vector<char>* results) {
+        std::unique_lock<std::mutex> locker(mtx);
+        sizes.push_back(items.size());
+        cond.notify_all();
+        if(sizes.size() == 1) { cond.wait(locker, [&] { return release; }); }
+        for(size_t i = 0; i < items.size(); i++) {
+            (*results)[i] = items[i].name.compare(0, 3, "bad") != 0;
+        }
+    };
+    GroupCommit* commit = GroupCommit::Instance();
+    /* 窗口 10 秒：凑满 K 个时不等窗口，同时有批次在提交也立即并行提交 */
+    commit->Init(K, 10000000, executor);
+    commit->Take();
+    std::vector<std::thread> threads;
+    std::atomic<int> ok(0);
+    /* 没有批次在提交时第一个注册立即单独提交 */
+    threads.emplace_back([&] { if(commit->Insert("first", "pw")) { ok++; } });
+    {
+        std::unique_lock<std::mutex> locker(mtx);
+        cond.wait(locker, [&] { return sizes.size() == 1; });
+    }
+    for(int i = 0; i < K; i++) {
+        threads.emplace_back([&, i] {
+            std::string name = (i % 3 == 0 ? "bad" : "user") + std::to_string(i);
+            bool ret = commit->Insert(name, "pw");
+            assert(ret == (i % 3 != 0));
+            if(ret) { ok++; }
+        });
+    }
+    {
+        std::unique_lock<std::mutex> locker(mtx);
+        assert(cond.wait_for(locker, std::chrono::seconds(5), [&] { return sizes.size() == 2; }));
+        release = true;
+        cond.notify_all();
+    }
+    for(auto& t : threads) { t.join(); }
+    assert(sizes.size() == 2 && sizes[0] == 1 && sizes[1] == K);
+    assert(ok == 1 + K - 2);
+    GroupCommit::Stats st = commit->Take();
+    assert(st.batches == 2 && st.rows == 1 + K);
+
+    /* maxBatch 为 1：不合并，每个注册一批 */
+    sizes.clear();
+    release = true;
+    commit->Init(1, 0, executor);
+    threads.clear();
+    for(int i = 0; i < 4; i++) {
+        threads.emplace_back([&, i] { assert(commit->Insert("one" + std::to_string(i), "pw")); });
+    }
+    for(auto& t : threads) { t.join(); }
+    st = commit->Take();
+    assert(st.batches == 4 && st.rows == 4);
+    commit->Init(1, 0);
+    printf("TestGroupCommit ok\n");
+}
+
+void TestMemUserStore() {
+    MemUserStore store(100);
+    std::string pwd;
+    assert(store.Find("alice", &pwd) == UserStore::NOT_FOUND);
+    assert(store.Insert("alice", "pw1"));
+    assert(!store.Insert("alice", "pw2"));      // 重名
+    assert(store.Find("alice", &pwd) == UserStore::FOUND && pwd == "pw1");
+    /* 容量用完后插入失败，已有用户不受影响 */
+    for(int i = 1; i < 100; i++) { assert(store.Insert("u" + std::to_string(i), "pw")); }
+    assert(!store.Insert("extra", "pw"));
+    assert(store.Find("u99", &pwd) == UserStore::FOUND);
+    std::vector<std::string> names;
+    assert(store.LoadNames(&names) && names.size() == 100);
+
+    /* 并发插入同一批用户名：每个名字恰好一个线程成功 */
+    MemUserStore shared(4000);
+    std::atomic<int> inserted(0);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; t++) {
+        threads.emplace_back([&] {
+            for(int i = 0; i < 1000; i++) {
+                if(shared.Insert("n" + std::to_string(i), "pw")) { inserted++; }
+            }
+        });
+    }
+    for(auto& t : threads) { t.join(); }
+    assert(inserted == 1000);
+    for(int i = 0; i < 1000; i++) { assert(shared.Find("n" + std::to_string(i), &pwd) == UserStore::FOUND); }
+
+    /* 用户名过滤器从存储载入：已有的一定判为可能存在，注册写入后立即可见 */
+    UserCache* cache = UserCache::Instance();
+    assert(cache->MayExist("anyone"));          // 未开启时总是 true
+    assert(cache->LoadFilter(&shared) && cache->FilterEnabled());
+    for(int i = 0; i < 1000; i++) { assert(cache->MayExist("n" + std::to_string(i))); }
+    int falsePositive = 0;
+    for(int i = 0; i < 10000; i++) {
+        if(cache->MayExist("missing" + std::to_string(i))) { falsePositive++; }
+    }
+    assert(falsePositive < 200);                // 设计误判率约 1%
+    assert(!cache->MayExist("newcomer"));
+    cache->Put("newcomer", "pw");
+    assert(cache->MayExist("newcomer"));
+    printf("TestMemUserStore ok\n");
+}
+
+void TestLogRing() {
+    /* 4 个槽位：写满后 Claim 返回 nullptr，Drain 按顺序取出 */
+    LogRing ring(4);
+    std::vector<std::string> got;
+    auto collect = [&](const char* data, size_t len, auto...) { got.emplace_back(data, len); };
+    int seq = 0;
+    for(int i = 0; i < 4; i++) {
+        char* slot = ring.Claim();
+        assert(slot);
+        ring.Commit(snprintf(slot, LogRing::LINE_SIZE, "line %d", seq++));
+    }
+    assert(!ring.Claim());
+    assert(ring.Drain(collect) == 4);
+    assert(got.size() == 4 && got[0] == "line 0" && got[3] == "line 3");
+    assert(ring.Empty() && ring.Drain(collect) == 0);
+
+    /* 反复绕环：每轮写 3 行再取出，下标越过槽位数后顺序和内容不变 */
+    for(int round = 0; round < 100; round++) {
+        got.clear();
+        int first = seq;
+        for(int i = 0; i < 3; i++) {
+            char* slot = ring.Claim();
+            assert(slot);
+            ring.Commit(snprintf(slot, LogRing::LINE_SIZE, "line %d", seq++));
+        }
+        assert(ring.Drain(collect) == 3);
+        for(int i = 0; i < 3; i++) {
+            assert(got[i] == "line " + std::to_string(first + i));
+        }
+    }
+
+    /* 恰好占满一个槽位的行原样取出 */
+    char* slot = ring.Claim();
+    memset(slot, 'x', LogRing::LINE_SIZE);
+    ring.Commit(LogRing::LINE_SIZE);
+    got.clear();
+    assert(ring.Drain(collect) == 1);
+    assert(got[0] == std::string(LogRing::LINE_SIZE, 'x'));
+
+    /* 超长的行被截断到一个槽位内，且仍以换行结尾 */
+    Log::Instance()->init(0, "./testlogring", ".log", 0);
+    std::string longLine(LogRing::LINE_SIZE * 2, 'y');
+    Log::Instance()->write(1, "%s", longLine.c_str());
+    Log::Instance()->flush();
+    time_t now = time(nullptr);
+    struct tm t;
+    localtime_r(&now, &t);
+    char name[64];
+    snprintf(name, sizeof(name), "./testlogring/%04d_%02d_%02d.log", t.tm_year + 1900, t.tm_mon + 1, t.tm_mday);
+    FILE* fp = fopen(name, "r");
+    assert(fp);
+    char buf[LogRing::LINE_SIZE * 4];
+    size_t n = fread(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+    std::string text(buf, n);
+    size_t start = text.find("yyyy");
+    start = text.rfind('\n', start);
+    start = (start == std::string::npos) ? 0 : start + 1;
+    size_t end = text.find('\n', start);
+    assert(end != std::string::npos);
+    assert(end + 1 - start <= LogRing::LINE_SIZE);
+    assert(end + 1 - start >= LogRing::LINE_SIZE - 2);
+    assert(text[end - 1] == 'y');
+}
+
+void TestLogBinary() {
+    /* RecordWriter 编码的参数经 ParseArgs/Render 还原后，与 printf 直接格式化的结果一致 */
+    const char* format = "%s %d %lu %zu %c %*d|%5.2f %-4s|%hhd";
+    const char* name = "user";
+    int i = -42;
+    unsigned long ul = 1UL << 40;
+    size_t z = 12345;
+    char c = 'x';
+    int width = 6, value = 77;
+    double d = 3.14159;
+    const char* tag = "ab";
+    int small = 300;    // %hhd 按 signed char 截断
+    char buf[LogRing::LINE_SIZE];
+    logbin::RecordWriter writer(buf, sizeof(buf), 2, 7);
+    writer.Put(name);
+    writer.Put(i);
+    writer.Put(ul);
+    writer.Put(z);
+    writer.Put(c);
+    writer.Put(width);
+    writer.Put(value);
+    writer.Put(d);
+    writer.Put(tag);
+    writer.Put(small);
+    size_t len = writer.Finish();
+    assert(buf[0] == logbin::RECORD && buf[1] == 2);
+    uint16_t argLen;
+    uint32_t id;
+    memcpy(&argLen, buf + 2, 2);
+    memcpy(&id, buf + 4, 4);
+    assert(id == 7 && len == logbin::RECORD_HEADER + argLen);
+    char expect[256];
+    snprintf(expect, sizeof(expect), format, name, i, ul, z, c, width, value, d, tag, (signed char)small);
+    std::vector<logbin::Arg> args = logbin::ParseArgs(buf + logbin::RECORD_HEADER, argLen);
+    assert(args.size() == 10);
+    assert(logbin::Render(format, args) == expect);
+
+    /* 缓冲放不下的参数整体丢弃，还原时显示为 <?> */
+    logbin::RecordWriter tiny(buf, logbin::RECORD_HEADER + 9 + 4, 1, 1);
+    tiny.Put(i);
+    tiny.Put(value);
+    tiny.Put(name);
+    len = tiny.Finish();
+    args = logbin::ParseArgs(buf + logbin::RECORD_HEADER, len - logbin::RECORD_HEADER);
+    assert(logbin::Render("%d %d %s", args) == "-42 <?> <?>");
+}
+
+void TestModuleLevels() {
+    Log* log = Log::Instance();
+    log->SetLevel(1);
+    assert(log->SetModuleLevels("http=0,pool=3"));
+    assert(log->GetLevel(Log::HTTP) == 0 && log->GetLevel(Log::POOL) == 3);
+    assert(log->GetLevel(Log::CORE) == 1 && log->GetLevel(Log::SERVER) == 1 && log->GetLevel(Log::TIMER) == 1);
+    assert(log->SetModuleLevels("") && log->SetModuleLevels("timer=2,"));
+    assert(log->GetLevel(Log::TIMER) == 2);
+
+    /* 无法识别的项返回 false，其余项照常生效 */
+    assert(!log->SetModuleLevels("core=3,httpx=2,server=,pool=x,sql=1,http=2"));
+    assert(log->GetLevel(Log::CORE) == 3 && log->GetLevel(Log::HTTP) == 2);
+    assert(log->GetLevel(Log::SERVER) == 1 && log->GetLevel(Log::POOL) == 3);
+
+    /* 按源文件所在目录归入模块 */
+    static_assert(LogModuleOf("../code/http/httpconn.cpp") == Log::HTTP);
+    static_assert(LogModuleOf("code/pool/threadpool.h") == Log::POOL);
+    static_assert(LogModuleOf("code/log/log.cpp") == Log::CORE);
+    static_assert(LogModuleOf("main.cpp") == Log::CORE);
+    log->SetLevel(0);
+}
+
+static void FillRing(LogRing& ring, int n, int level, int* seq) {
+    for(int i = 0; i < n; i++) {
+        char* slot = ring.Claim();
+        assert(slot);
+        ring.Commit(snprintf(slot, LogRing::LINE_SIZE, "line %d", (*seq)++), logbin::TEXT, level);
+    }
+}
+
+void TestLogRingPolicies() {
+    std::vector<std::string> got;
+    auto collect = [&](const char* data, size_t len, uint8_t) { got.emplace_back(data, len); };
+    int seq = 0;
+
+    /* block / drop_newest：环满时 Claim 返回 nullptr，调用者等待或记一次丢弃 */
+    LogRing ring(4);
+    FillRing(ring, 4, 1, &seq);
+    assert(!ring.Claim());
+    ring.CountDrop(1);
+    ring.CountDrop(3);
+    ring.CountDrop(3);
+    assert(ring.TakeDrops(0) == 0 && ring.TakeDrops(1) == 1 && ring.TakeDrops(3) == 2);
+    assert(ring.TakeDrops(3) == 0);     // 只取新增的部分
+    assert(ring.Drain(collect) == 4 && ring.Claim());
+
+    /* sample：过半之后才抽样，每 rate 行保留一行 */
+    LogRing sampled(8);
+    assert(!sampled.OverHalf());
+    FillRing(sampled, 5, 1, &seq);
+    assert(sampled.OverHalf());
+    int kept = 0;
+    for(int i = 0; i < 30; i++) {
+        if(sampled.Sample(10)) { kept++; }
+    }
+    assert(kept == 3);
+
+    /* drop_oldest：环满时挤掉最旧的一行并报告它的级别，DrainShared 取到的是剩下的行 */
+    LogRing shared(4);
+    got.clear();
+    seq = 0;
+    FillRing(shared, 3, 0, &seq);
+    FillRing(shared, 1, 2, &seq);
+    int dropped;
+    for(int i = 0; i < 2; i++) {
+        char* slot = shared.ClaimOverwrite(&dropped);
+        assert(slot && dropped == 0);
+        shared.Commit(snprintf(slot, LogRing::LINE_SIZE, "line %d", seq++), logbin::TEXT, 1);
+    }
+    assert(shared.DrainShared(collect) == 4);
+    assert(got[0] == "line 2" && got[1] == "line 3" && got[3] == "line 5");
+    char* slot = shared.ClaimOverwrite(&dropped);
+    assert(slot && dropped == -1);
+    shared.Commit(0);
+    got.clear();
+    shared.DrainShared(collect);
+
+    /* 消费者读取某一行期间，生产者不能复用这个槽位：ClaimOverwrite 返回 nullptr，本行由调用者丢弃 */
+    FillRing(shared, 4, 1, &seq);
+    bool checked = false;
+    assert(shared.DrainShared([&](const char* data, size_t len, uint8_t) {
+        if(!checked) {
+            checked = true;
+            std::string first(data, len);
+            int level;
+            assert(!shared.ClaimOverwrite(&level));     // 与正在读的行同一个槽位
+            assert(std::string(data, len) == first);
+        }
+    }) == 4);
+    assert(checked && shared.ClaimOverwrite(&dropped) && dropped == -1);
+
+    /* 并发：生产者一直挤掉最旧的行，消费者取到的每一行都必须完整（整行是同一个字符） */
+    LogRing race(8);
+    std::atomic<bool> stop(false);
+    std::atomic<int> torn(0);
+    std::atomic<long> drained(0);
+    std::thread consumer([&] {
+        auto check = [&](const char* data, size_t len, uint8_t) {
+            for(size_t i = 1; i < len; i++) {
+                if(data[i] != data[0]) { torn++; break; }
+            }
+            drained++;
+        };
+        while(!stop.load()) { race.DrainShared(check); }
+        race.DrainShared(check);
+    });
+    for(int i = 0; i < 200000; i++) {
+        char* line = race.ClaimOverwrite(&dropped);
+        if(!line) { continue; }
+        size_t len = 64 + i % 400;
+        memset(line, 'a' + i % 26, len);
+        race.Commit(len);
+    }
+    stop = true;
+    consumer.join();
+    assert(torn == 0 && drained > 0);
+
+    assert(Log::Instance()->SetFullPolicy("drop_oldest", 4) && !Log::Instance()->SetFullPolicy("drop"));
+    assert(Log::Instance()->SetFullPolicy("block"));
+}
+
 int main() {
+    TestCompressor();
+    TestMpmcQueue();
+    TestTask();
+    TestPoolQueueFull();
+    TestPoolParkWake();
+    TestCoDel();
+    TestUserCache();
+    TestSessionStore();
+    TestGroupCommit();
+    TestMemUserStore();
+    TestLogRing();
+    TestLogBinary();
+    TestModuleLevels();
+    TestLogRingPolicies();
     TestLog();
     TestThreadPool();
 }
\ No newline at end of file